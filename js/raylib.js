@@ -40,6 +40,8 @@ class RaylibJs {
         this.entryFunction = undefined;
         this.prevPressedKeyState = new Set();
         this.currentPressedKeyState = new Set();
+        this.keyPressedQueue = [];
+        this.charPressedQueue = [];
         this.prevMouseButtonState = new Set();
         this.currentMouseButtonState = new Set();
         this.currentMouseWheelMoveState = 0;
@@ -74,7 +76,10 @@ class RaylibJs {
         });
 
         const keyDown = (e) => {
-            this.currentPressedKeyState.add(glfwKeyMapping[e.code]);
+            const key = glfwKeyMapping[e.code];
+            this.currentPressedKeyState.add(key);
+            if (!e.repeat && key !== undefined) this.keyPressedQueue.push(key);
+            if (e.key.length === 1) this.charPressedQueue.push(e.key.codePointAt(0));
         };
         const keyUp = (e) => {
             this.currentPressedKeyState.delete(glfwKeyMapping[e.code]);
@@ -214,6 +219,10 @@ class RaylibJs {
         return Math.min(this.dt, 1.0/this.targetFPS);
     }
 
+    GetTime() {
+        return performance.now()/1000.0;
+    }
+
     BeginDrawing() {}
 
     EndDrawing() {
@@ -222,6 +231,8 @@ class RaylibJs {
         this.prevMouseButtonState = new Set(this.currentMouseButtonState);
         this.prevPressedKeyState.clear();
         this.prevPressedKeyState = new Set(this.currentPressedKeyState);
+        this.keyPressedQueue.length = 0;
+        this.charPressedQueue.length = 0;
         this.currentMouseWheelMoveState = 0.0;
     }
 
@@ -422,6 +433,16 @@ class RaylibJs {
         return this.currentPressedKeyState.has(key);
     }
 
+    // RLAPI int GetKeyPressed(void); // Get key pressed (keycode), call it multiple times for keys queued, returns 0 when the queue is empty
+    GetKeyPressed() {
+        return this.keyPressedQueue.shift() ?? 0;
+    }
+
+    // RLAPI int GetCharPressed(void); // Get char pressed (unicode), call it multiple times for chars queued, returns 0 when the queue is empty
+    GetCharPressed() {
+        return this.charPressedQueue.shift() ?? 0;
+    }
+
     GetMouseWheelMove() {
       return this.currentMouseWheelMoveState;
     }
@@ -593,6 +614,61 @@ class RaylibJs {
         this.ctx.fillText(text, posX, posY + fontSize);
     }
 
+    // Draws a frame of render commands from src/render.h in one call. A
+    // command is nine 4 byte fields: kind, color, x, y, width, height,
+    // roundness or font size, thickness or spacing and the text offset.
+    render_js_flush(commands_ptr, count, text_ptr, font_ptr) {
+        const buffer = this.wasm.instance.exports.memory.buffer;
+        const ints = new Int32Array(buffer, commands_ptr, count*RENDER_COMMAND_FIELDS);
+        const floats = new Float32Array(buffer, commands_ptr, count*RENDER_COMMAND_FIELDS);
+        const bytes = new Uint8Array(buffer, commands_ptr, count*RENDER_COMMAND_FIELDS*4);
+        const font = `custom_font${new Uint8Array(buffer, font_ptr, 1)[0]}`;
+        for (let i = 0; i < count; ++i) {
+            const field = i*RENDER_COMMAND_FIELDS;
+            const color = color_hex_unpacked(bytes[field*4 + 4], bytes[field*4 + 5], bytes[field*4 + 6], bytes[field*4 + 7]);
+            const x = floats[field + 2];
+            const y = floats[field + 3];
+            const w = floats[field + 4];
+            const h = floats[field + 5];
+            switch (ints[field]) {
+                case RENDER_CLEAR: {
+                    this.ctx.fillStyle = color;
+                    this.ctx.fillRect(0, 0, this.ctx.canvas.width, this.ctx.canvas.height);
+                } break;
+                case RENDER_RECTANGLE: {
+                    this.ctx.fillStyle = color;
+                    this.ctx.fillRect(x, y, w, h);
+                } break;
+                case RENDER_RECTANGLE_LINES: {
+                    this.ctx.strokeStyle = color;
+                    this.ctx.lineWidth = 1;
+                    this.ctx.strokeRect(x, y, w, h);
+                } break;
+                case RENDER_RECTANGLE_ROUNDED:
+                case RENDER_RECTANGLE_ROUNDED_LINES: {
+                    const roundness = Math.min(floats[field + 6], 1.0);
+                    const radius = w > h ? (h*roundness)/2 : (w*roundness)/2;
+                    this.ctx.beginPath();
+                    this.ctx.roundRect(x, y, w, h, radius);
+                    if (ints[field] === RENDER_RECTANGLE_ROUNDED) {
+                        this.ctx.fillStyle = color;
+                        this.ctx.fill();
+                    } else {
+                        this.ctx.strokeStyle = color;
+                        this.ctx.lineWidth = floats[field + 7];
+                        this.ctx.stroke();
+                    }
+                } break;
+                case RENDER_TEXT: {
+                    const fontSize = floats[field + 6];
+                    this.ctx.fillStyle = color;
+                    this.ctx.font = fontSize+`px ${font}`;
+                    this.ctx.fillText(cstr_by_ptr(buffer, text_ptr + ints[field + 8]), x, y + fontSize);
+                } break;
+            }
+        }
+    }
+
     Vector2Distance(vector1_ptr, vector2_ptr) {
         const buffer = this.wasm.instance.exports.memory.buffer;
         const [v1_x, v1_y] = new Float32Array(buffer, vector1_ptr, 2);
@@ -698,6 +774,15 @@ class RaylibJs {
     }
 }
 
+// Render_Kind of src/render.h
+const RENDER_CLEAR                   = 0;
+const RENDER_RECTANGLE               = 1;
+const RENDER_RECTANGLE_LINES         = 2;
+const RENDER_RECTANGLE_ROUNDED       = 3;
+const RENDER_RECTANGLE_ROUNDED_LINES = 4;
+const RENDER_TEXT                    = 5;
+const RENDER_COMMAND_FIELDS          = 9;
+
 const glfwMouseButtonMapping = {
     0: 0, // MOUSE_BUTTON_LEFT
     2: 1, // MOUSE_BUTTON_RIGHT
@@ -4,40 +4,346 @@
 #include <stdbool.h>
 
 #define SOURCE_FILE_PATH "./src/wordle.c"
+#define LIBWORDLE_SOURCE_PATH "./src/libwordle.c"
+#define STATS_HEADER_PATH "./src/stats.h"
+#define RENDER_HEADER_PATH "./src/render.h"
+#define PROFILER_HEADER_PATH "./src/profiler.h"
+#define TRACE_HEADER_PATH "./src/trace.h"
+#define LIBWORDLE_HEADER_PATH "./src/libwordle.h"
+#define CLI_SOURCE_FILE_PATH "./src/wordle_cli.c"
+#define BOT_SOURCE_FILE_PATH "./src/wordle_bot.c"
+#define SERVER_SOURCE_FILE_PATH "./src/wordle_server.c"
+#define LOADGEN_SOURCE_FILE_PATH "./src/wordle_loadgen.c"
+#define WEB_SOURCE_FILE_PATH "./src/wordle_web.c"
+#define REPLAY_SOURCE_FILE_PATH "./src/wordle_replay.c"
+#define BENCH_SOURCE_FILE_PATH "./src/wordle_bench.c"
+#define FUZZ_SOURCE_FILE_PATH "./src/wordle_fuzz.c"
+#define GOLDEN_SOURCE_FILE_PATH "./src/wordle_golden.c"
+#define PRECOMPRESSED_DIR "./build/www"
+#define BENCH_RESULTS_DIR "./build/bench"
+#define BENCH_BASELINE_PATH "./bench/baseline.json"
+#define DEFAULT_SERVE_PORT "6969"
 #define CFLAGS "-O3", "-Wall", "-Wextra", "-g", "-pedantic"
 
 
+#define TRIE_LETTERS 26
+
+typedef struct {
+    int children[TRIE_LETTERS];
+    int word;
+} Trie_Builder_Node;
+
+typedef struct {
+    Trie_Builder_Node *items;
+    size_t count;
+    size_t capacity;
+} Trie_Builder;
+
+int trie_builder_new_node(Trie_Builder *trie)
+{
+    Trie_Builder_Node node = {0};
+    node.word = -1;
+    da_append(trie, node);
+    return trie->count - 1;
+}
+
+void trie_builder_insert(Trie_Builder *trie, String_View word, int index)
+{
+    int node = 0;
+    for (size_t i = 0; i < word.count; ++i) {
+        int letter = word.data[i] - 'A';
+        if (trie->items[node].children[letter] == 0) {
+            int child = trie_builder_new_node(trie);
+            trie->items[node].children[letter] = child;
+        }
+        node = trie->items[node].children[letter];
+    }
+    trie->items[node].word = index;
+}
+
+/* Lays the trie out in breadth-first order so that the children of every
+ * node are stored next to each other. A node then only needs a bitmask of
+ * its letters and the index of its first child: the child for a letter is
+ * found by counting the bits below it. Leaves store the word index instead. */
+void append_trie(String_Builder *sb, Trie_Builder *trie)
+{
+    int *queue = malloc(trie->count * sizeof(*queue));
+    size_t head = 0, tail = 0;
+    queue[tail++] = 0;
+
+    sb_append_cstr(sb, "Trie_Node trie[TRIE_NODES] = {\n");
+    while (head < tail) {
+        Trie_Builder_Node *node = &trie->items[queue[head++]];
+        unsigned int letters = 0;
+        int first = node->word >= 0 ? node->word : (int) tail;
+        for (int letter = 0; letter < TRIE_LETTERS; ++letter) {
+            if (node->children[letter] == 0) continue;
+            letters |= 1u << letter;
+            queue[tail++] = node->children[letter];
+        }
+        sb_append_cstr(sb, temp_sprintf("    {0x%07X, %d},\n", letters, first));
+    }
+    sb_append_cstr(sb, "};\n");
+
+    free(queue);
+}
+
+
+/* Bit sets of the words containing every letter, in blocks of 64 words */
+typedef struct {
+    unsigned long long *items;      // TRIE_LETTERS blocks for every 64 words, [block][letter]
+    size_t count;
+    size_t capacity;
+} Letter_Words;
+
+void letter_words_insert(Letter_Words *letter_words, String_View word, int index)
+{
+    if (index % 64 == 0) {
+        for (int letter = 0; letter < TRIE_LETTERS; ++letter) da_append(letter_words, 0);
+    }
+    unsigned long long *block = &letter_words->items[index/64*TRIE_LETTERS];
+    for (size_t i = 0; i < word.count; ++i) {
+        block[word.data[i] - 'A'] |= 1ULL << (index % 64);
+    }
+}
+
+void append_letter_words(String_Builder *sb, Letter_Words *letter_words)
+{
+    size_t blocks = letter_words->count / TRIE_LETTERS;
+    sb_append_cstr(sb, temp_sprintf("unsigned long long letter_words[%d][(WORDS + 63)/64] = {\n", TRIE_LETTERS));
+    for (int letter = 0; letter < TRIE_LETTERS; ++letter) {
+        sb_append_cstr(sb, "    {");
+        for (size_t block = 0; block < blocks; ++block) {
+            sb_append_cstr(sb, block % 4 == 0 ? "\n        " : " ");
+            sb_append_cstr(sb, temp_sprintf("0x%016llXULL,", letter_words->items[block*TRIE_LETTERS + letter]));
+        }
+        sb_append_cstr(sb, "\n    },\n");
+    }
+    sb_append_cstr(sb, "};\n");
+}
+
+
+/* words.h follows the stb convention: it only declares the word list, the
+ * trie and the letter sets unless WORDS_IMPLEMENTATION is defined before
+ * including it. The letter sets are built here, so the library has no
+ * tables to fill at run time and threads can use it without locks. */
 bool generate_words_header()
 {
     String_Builder words = {0};
     if (!read_entire_file("./src/words.txt", &words)) return false;
     String_View sv = nob_sb_to_sv(words);
     String_Builder sb = {0};
+    String_Builder words_array = {0};
+    Trie_Builder trie = {0};
+    trie_builder_new_node(&trie);
+    Letter_Words letter_words = {0};
 
-    sb_append_cstr(&sb, "#ifndef WORDS_H_\n");
-    sb_append_cstr(&sb, "#define WORDS_H_\n");
-
-    sb_append_cstr(&sb, "char words[][6] = {\n");
+    sb_append_cstr(&words_array, "char words[WORDS][WORD_LEN + 1] = {\n");
     int words_count = 0;
     while (sv.count) {
         sv = nob_sv_trim_left(sv);
         if (sv.count <= 0) break;
 
         String_View word = sv_chop_by_delim(&sv, '\n');
+        word = sv_trim_right(word);
 
-        sb_append_cstr(&sb, "    \"");
-        sb_append_buf(&sb, word.data, word.count);
-        sb_append_cstr(&sb, "\",\n");
+        sb_append_cstr(&words_array, "    \"");
+        sb_append_buf(&words_array, word.data, word.count);
+        sb_append_cstr(&words_array, "\",\n");
+        trie_builder_insert(&trie, word, words_count);
+        letter_words_insert(&letter_words, word, words_count);
         ++words_count;
     }
-    sb_append_cstr(&sb, "};\n");
+    sb_append_cstr(&words_array, "};\n");
+
+    sb_append_cstr(&sb, "#ifndef WORDS_H_\n");
+    sb_append_cstr(&sb, "#define WORDS_H_\n");
 
     sb_append_cstr(&sb, temp_sprintf("#define WORDS %d\n", words_count));
     sb_append_cstr(&sb, "#define WORD_LEN 5\n");
+    sb_append_cstr(&sb, temp_sprintf("#define TRIE_NODES %zu\n", trie.count));
+
+    sb_append_cstr(&sb, "typedef struct Trie_Node {\n");
+    sb_append_cstr(&sb, "    unsigned int letters; // Bit per letter that continues this prefix\n");
+    sb_append_cstr(&sb, "    int first;            // Index of the first child, or of the word for leaves\n");
+    sb_append_cstr(&sb, "} Trie_Node;\n");
 
+    sb_append_cstr(&sb, "extern char words[WORDS][WORD_LEN + 1];\n");
+    sb_append_cstr(&sb, "extern Trie_Node trie[TRIE_NODES];\n");
+    sb_append_cstr(&sb, temp_sprintf("extern unsigned long long letter_words[%d][(WORDS + 63)/64];\n", TRIE_LETTERS));
     sb_append_cstr(&sb, "#endif // WORDS_H_\n");
 
-    return nob_write_entire_file("./build/words.h", sb.items, sb.count);
+    sb_append_cstr(&sb, "#ifdef WORDS_IMPLEMENTATION\n");
+    sb_append_buf(&sb, words_array.items, words_array.count);
+    append_trie(&sb, &trie);
+    append_letter_words(&sb, &letter_words);
+    sb_append_cstr(&sb, "#endif // WORDS_IMPLEMENTATION\n");
+
+    bool result = nob_write_entire_file("./build/words.h", sb.items, sb.count);
+    da_free(trie);
+    da_free(letter_words);
+    sb_free(words_array);
+    sb_free(sb);
+    sb_free(words);
+    return result;
+}
+
+
+/* Builds a native program from a single source file linked with libwordle */
+bool build_tool(Cmd *cmd, const char *output_path, const char *source_path, bool debug)
+{
+    const char *inputs[] = { source_path, LIBWORDLE_HEADER_PATH, "./build/libwordle.a" };
+    if (!debug && needs_rebuild(output_path, inputs, ARRAY_LEN(inputs)) != 1) {
+        nob_log(NOB_INFO, "'%s' is up to date. ", output_path);
+        return true;
+    }
+
+    cmd_append(cmd, "clang", CFLAGS);
+    cmd_append(cmd, "-I./build/");
+    cmd_append(cmd, "-o", output_path, source_path);
+    cmd_append(cmd, "-L./build/", "-lwordle", "-lm", "-pthread");
+    if (debug) cmd_append(cmd, "-DDEBUG");
+    return cmd_run_sync_and_reset(cmd);
+}
+
+
+/* Builds a tool that compiles in wordle.c with PLATFORM_HEADLESS. It only
+ * uses the parts of raylib that do not need a window, so raylib is linked
+ * statically and the tool runs without a display. */
+bool build_headless_tool(Cmd *cmd, const char *output_path, const char *source_path, bool debug)
+{
+    const char *inputs[] = { source_path, SOURCE_FILE_PATH, STATS_HEADER_PATH, RENDER_HEADER_PATH, PROFILER_HEADER_PATH, TRACE_HEADER_PATH, LIBWORDLE_HEADER_PATH, "./build/libwordle.a" };
+    if (!debug && needs_rebuild(output_path, inputs, ARRAY_LEN(inputs)) != 1) {
+        nob_log(NOB_INFO, "'%s' is up to date. ", output_path);
+        return true;
+    }
+
+    cmd_append(cmd, "clang", CFLAGS);
+    cmd_append(cmd, "-I./build/");
+    cmd_append(cmd, "-I./raylib/raylib-5.5_linux_amd64/include");
+    cmd_append(cmd, "-o", output_path, source_path);
+    cmd_append(cmd, "-L./build/", "-lwordle");
+    cmd_append(cmd, "./raylib/raylib-5.5_linux_amd64/lib/libraylib.a", "-lm");
+    if (debug) cmd_append(cmd, "-DDEBUG");
+    return cmd_run_sync_and_reset(cmd);
+}
+
+
+/* Web assets worth compressing, the rest are already compressed formats */
+static const char *compressed_assets[] = {
+    "wasm/wordle.wasm",
+    "js/raylib.js",
+    "assets/fonts/Oswald-Bold.ttf",
+    "assets/fonts/AnekLatin-Light.ttf",
+};
+
+
+bool program_exists(const char *name)
+{
+    const char *path = getenv("PATH");
+    while (path != NULL && *path != '\0') {
+        const char *end = strchr(path, ':');
+        size_t len = end ? (size_t)(end - path) : strlen(path);
+        const char *candidate = temp_sprintf("%.*s/%s", (int) len, path, name);
+        if (access(candidate, X_OK) == 0) return true;
+        path = end ? end + 1 : NULL;
+    }
+    return false;
+}
+
+
+/* Creates every directory along the path of a file */
+bool mkdir_parents(const char *file_path)
+{
+    char *path = temp_strdup(file_path);
+    for (char *p = path + 1; *p != '\0'; ++p) {
+        if (*p != '/') continue;
+        *p = '\0';
+        if (!mkdir_if_not_exists(path)) return false;
+        *p = '/';
+    }
+    return true;
+}
+
+
+/* Compresses the file with `program -c` into output_path */
+bool compress_asset(Cmd *cmd, const char *program, const char *level, const char *input_path, const char *output_path)
+{
+    if (needs_rebuild1(output_path, input_path) != 1) {
+        nob_log(NOB_INFO, "'%s' is up to date. ", output_path);
+        return true;
+    }
+    Fd fdout = fd_open_for_write(output_path);
+    if (fdout == NOB_INVALID_FD) return false;
+    cmd_append(cmd, program, level, "-c", input_path);
+    return cmd_run_sync_redirect_and_reset(cmd, (Cmd_Redirect) { .fdout = &fdout });
+}
+
+
+/* Writes gzip and, when the brotli tool is installed, brotli copies of the
+ * assets for wordle-web to send as they are */
+bool precompress_assets(Cmd *cmd)
+{
+    bool brotli = program_exists("brotli");
+    if (!brotli) nob_log(NOB_WARNING, "brotli is not installed, assets are precompressed with gzip only");
+
+    for (size_t i = 0; i < ARRAY_LEN(compressed_assets); ++i) {
+        const char *asset = compressed_assets[i];
+        const char *input_path = temp_sprintf("./%s", asset);
+        if (!mkdir_parents(temp_sprintf("%s/%s", PRECOMPRESSED_DIR, asset))) return false;
+        if (!compress_asset(cmd, "gzip", "-9n", input_path, temp_sprintf("%s/%s.gz", PRECOMPRESSED_DIR, asset))) return false;
+        if (brotli && !compress_asset(cmd, "brotli", "-q11", input_path, temp_sprintf("%s/%s.br", PRECOMPRESSED_DIR, asset))) return false;
+    }
+    return true;
+}
+
+
+/* Short hash of HEAD, with -dirty when tracked files have changes, so
+ * benchmark results name the code they measured */
+const char *git_commit(void)
+{
+    char hash[64] = {0};
+    FILE *git = popen("git rev-parse --short HEAD 2>/dev/null", "r");
+    if (git == NULL) return "unknown";
+    bool ok = fgets(hash, sizeof(hash), git) != NULL;
+    pclose(git);
+    if (!ok) return "unknown";
+    hash[strcspn(hash, "\n")] = '\0';
+
+    char change[8] = {0};
+    git = popen("git status --porcelain --untracked-files=no 2>/dev/null", "r");
+    bool dirty = git != NULL && fgets(change, sizeof(change), git) != NULL;
+    if (git != NULL) pclose(git);
+    return temp_sprintf("%s%s", hash, dirty ? "-dirty" : "");
+}
+
+
+/* Runs the benchmarks, keeps their results by commit in BENCH_RESULTS_DIR
+ * and fails on regressions against the committed baseline. With
+ * save_baseline the results replace the baseline instead. */
+bool run_bench(Cmd *cmd, Cmd *args, bool save_baseline)
+{
+    const char *commit = git_commit();
+    const char *output_path = temp_sprintf("%s/%s.json", BENCH_RESULTS_DIR, commit);
+    if (save_baseline) {
+        if (!mkdir_parents(BENCH_BASELINE_PATH)) return false;
+        output_path = BENCH_BASELINE_PATH;
+    } else if (!mkdir_if_not_exists(BENCH_RESULTS_DIR)) {
+        return false;
+    }
+
+    cmd_append(cmd, "./build/wordle-bench", "--commit", commit, "--output", output_path);
+    if (!save_baseline) {
+        if (file_exists(BENCH_BASELINE_PATH) == 1) {
+            cmd_append(cmd, "--baseline", BENCH_BASELINE_PATH);
+        } else {
+            nob_log(NOB_WARNING, "there is no %s to compare with, save one with ./nob bench --save-baseline", BENCH_BASELINE_PATH);
+        }
+    }
+    da_append_many(cmd, args->items, args->count);
+    if (!cmd_run_sync_and_reset(cmd)) return false;
+    nob_log(NOB_INFO, "saved the results to %s", output_path);
+    return true;
 }
 
 
@@ -46,12 +352,33 @@ int main(int argc, char **argv)
     NOB_GO_REBUILD_URSELF(argc, argv);
 
     bool debug = false;
+    bool serve = false;
+    Cmd tool = {0}; // Tool to run after the build with the rest of the arguments
+    bool bench = false;
+    bool save_baseline = false;
+    Cmd bench_args = {0};
+    const char *port = DEFAULT_SERVE_PORT;
 
     (void) shift_args(&argc, &argv); // Skip program name
     while (argc > 0) {
         char *arg = shift_args(&argc, &argv);
         if (strcmp(arg, "--debug") == 0) {
             debug = true;
+        } else if (strcmp(arg, "serve") == 0) {
+            serve = true;
+        } else if (strcmp(arg, "bench") == 0) {
+            /* The rest of the arguments are for wordle-bench */
+            bench = true;
+            while (argc > 0) {
+                char *bench_arg = shift_args(&argc, &argv);
+                if (strcmp(bench_arg, "--save-baseline") == 0) save_baseline = true;
+                else cmd_append(&bench_args, bench_arg);
+            }
+        } else if (strcmp(arg, "fuzz") == 0 || strcmp(arg, "golden") == 0) {
+            cmd_append(&tool, temp_sprintf("./build/wordle-%s", arg));
+            while (argc > 0) cmd_append(&tool, shift_args(&argc, &argv));
+        } else if (strcmp(arg, "--port") == 0 && argc > 0) {
+            port = shift_args(&argc, &argv);
         }
     }
 
@@ -62,13 +389,30 @@ int main(int argc, char **argv)
     /* Create words.h */
     if (!generate_words_header(&cmd)) return 1;
 
+    /* Compile libwordle for linux */
+    const char *libwordle_inputs[] = { LIBWORDLE_SOURCE_PATH, LIBWORDLE_HEADER_PATH, "./src/words.txt" };
+    if (debug || needs_rebuild("./build/libwordle.a", libwordle_inputs, ARRAY_LEN(libwordle_inputs)) == 1) {
+        cmd_append(&cmd, "clang", CFLAGS);
+        cmd_append(&cmd, "-I./build/");
+        cmd_append(&cmd, "-c", "-o", "./build/libwordle.o", LIBWORDLE_SOURCE_PATH);
+        if (debug) cmd_append(&cmd, "-DDEBUG");
+        if (!cmd_run_sync_and_reset(&cmd)) return 1;
+
+        cmd_append(&cmd, "ar", "rcs", "./build/libwordle.a", "./build/libwordle.o");
+        if (!cmd_run_sync_and_reset(&cmd)) return 1;
+    } else {
+        nob_log(NOB_INFO, "'./build/libwordle.a' is up to date. ");
+    }
+
     /* Compile wordle for linux */
-    if (debug || needs_rebuild1("./build/wordle", SOURCE_FILE_PATH) == 1) {
+    const char *wordle_inputs[] = { SOURCE_FILE_PATH, STATS_HEADER_PATH, RENDER_HEADER_PATH, PROFILER_HEADER_PATH, TRACE_HEADER_PATH, LIBWORDLE_HEADER_PATH, "./build/libwordle.a" };
+    if (debug || needs_rebuild("./build/wordle", wordle_inputs, ARRAY_LEN(wordle_inputs)) == 1) {
         cmd_append(&cmd, "clang", CFLAGS);
         cmd_append(&cmd, "-I./build/");
         cmd_append(&cmd, "-I./");
         cmd_append(&cmd, "-I./raylib/raylib-5.5_linux_amd64/include");
         cmd_append(&cmd, "-o", "./build/wordle", SOURCE_FILE_PATH);
+        cmd_append(&cmd, "-L./build/", "-lwordle");
         cmd_append(&cmd, "-L./raylib/raylib-5.5_linux_amd64/lib");
         cmd_append(&cmd, "-lraylib", "-lm");
         if (debug) cmd_append(&cmd, "-DDEBUG");
@@ -77,20 +421,48 @@ int main(int argc, char **argv)
         nob_log(NOB_INFO, "'./build/wordle' is up to date. ");
     }
 
+    /* Compile headless tools for linux */
+    if (!build_tool(&cmd, "./build/wordle-cli", CLI_SOURCE_FILE_PATH, debug)) return 1;
+    if (!build_tool(&cmd, "./build/wordle-bot", BOT_SOURCE_FILE_PATH, debug)) return 1;
+    if (!build_tool(&cmd, "./build/wordle-server", SERVER_SOURCE_FILE_PATH, debug)) return 1;
+    if (!build_tool(&cmd, "./build/wordle-loadgen", LOADGEN_SOURCE_FILE_PATH, debug)) return 1;
+    if (!build_tool(&cmd, "./build/wordle-web", WEB_SOURCE_FILE_PATH, debug)) return 1;
+    if (!build_tool(&cmd, "./build/wordle-fuzz", FUZZ_SOURCE_FILE_PATH, debug)) return 1;
+    if (!build_headless_tool(&cmd, "./build/wordle-replay", REPLAY_SOURCE_FILE_PATH, debug)) return 1;
+    if (!build_headless_tool(&cmd, "./build/wordle-bench", BENCH_SOURCE_FILE_PATH, debug)) return 1;
+    if (!build_headless_tool(&cmd, "./build/wordle-golden", GOLDEN_SOURCE_FILE_PATH, debug)) return 1;
+
     /* Compile wordle for wasm */
-    if (debug || needs_rebuild1("./wasm/wordle.wasm", SOURCE_FILE_PATH) == 1) {
+    const char *wasm_inputs[] = { SOURCE_FILE_PATH, STATS_HEADER_PATH, RENDER_HEADER_PATH, PROFILER_HEADER_PATH, TRACE_HEADER_PATH, LIBWORDLE_SOURCE_PATH, LIBWORDLE_HEADER_PATH, "./src/words.txt" };
+    if (debug || needs_rebuild("./wasm/wordle.wasm", wasm_inputs, ARRAY_LEN(wasm_inputs)) == 1) {
         cmd_append(&cmd, "clang", CFLAGS);
         cmd_append(&cmd, "--target=wasm32", "--no-standard-libraries", "-Wl,--export-table", "-Wl,--no-entry", "-Wl,--allow-undefined", "-Wl,--export=main", "-Wl,--export=__head_base", "-Wl,--allow-undefined");
         cmd_append(&cmd, "-I./build/");
         cmd_append(&cmd, "-I./");
         cmd_append(&cmd, "-I./include");
         cmd_append(&cmd, "-I./raylib/raylib-5.5_linux_amd64/include");
-        cmd_append(&cmd, "-o", "./wasm/wordle.wasm", SOURCE_FILE_PATH, "-DPLATFORM_WEB");
+        cmd_append(&cmd, "-o", "./wasm/wordle.wasm", SOURCE_FILE_PATH, LIBWORDLE_SOURCE_PATH, "-DPLATFORM_WEB");
         if (debug) cmd_append(&cmd, "-DDEBUG");
         if (!cmd_run_sync_and_reset(&cmd)) return 1;
     } else {
         nob_log(NOB_INFO, "'./wasm/wordle.wasm' is up to date. ");
     }
 
+    /* Run the scoring fuzzer or the golden image tests */
+    if (tool.count > 0 && !cmd_run_sync_and_reset(&tool)) return 1;
+
+    /* Run the benchmarks against the baseline */
+    if (bench) {
+        if (debug) nob_log(NOB_WARNING, "benchmarking a debug build");
+        if (!run_bench(&cmd, &bench_args, save_baseline)) return 1;
+    }
+
+    /* Serve the wasm build */
+    if (serve) {
+        if (!precompress_assets(&cmd)) return 1;
+        cmd_append(&cmd, "./build/wordle-web", "--port", port, "--root", ".", "--precompressed", PRECOMPRESSED_DIR);
+        if (!cmd_run_sync_and_reset(&cmd)) return 1;
+    }
+
     return 0;
 }
@@ -0,0 +1,287 @@
+#include <stddef.h>
+
+#define WORDS_IMPLEMENTATION
+#include "libwordle.h"
+
+
+#ifdef PLATFORM_WEB
+/* There is no libc in the wasm build, but clang may still emit calls to
+ * these for struct copies and zero initializers. The volatile pointers
+ * keep it from turning the loops back into calls to themselves. */
+void *memset(void *dest, int c, size_t n)
+{
+    volatile unsigned char *d = dest;
+    while (n--) *d++ = c;
+    return dest;
+}
+
+void *memcpy(void *dest, const void *src, size_t n)
+{
+    volatile unsigned char *d = dest;
+    const unsigned char *s = src;
+    while (n--) *d++ = *s++;
+    return dest;
+}
+#endif
+
+
+void wordle_new_game(Wordle_Game *game, int answer)
+{
+    game->answer = answer;
+    game->attempt = 0;
+    game->status = WORDLE_STATUS_PLAYING;
+}
+
+
+Wordle_Guess_Result wordle_submit_guess(Wordle_Game *game, const char *guess)
+{
+    if (game->status != WORDLE_STATUS_PLAYING) return WORDLE_GUESS_GAME_OVER;
+
+    for (int i = 0; i < WORD_LEN; ++i) {
+        if (guess[i] == '\0') return WORDLE_GUESS_INCOMPLETE;
+    }
+#ifndef DEBUG
+    if (wordle_find_word(guess) < 0) return WORDLE_GUESS_UNKNOWN_WORD;
+#endif
+
+    Wordle_Feedback feedback[WORD_LEN];
+    wordle_score(guess, words[game->answer], feedback);
+    int pattern = wordle_feedback_pattern(feedback);
+    game->guesses[game->attempt] = wordle_pack_word(guess);
+    game->patterns[game->attempt] = pattern;
+    game->attempt += 1;
+
+    if (pattern == WORDLE_PATTERNS - 1) {
+        game->status = WORDLE_STATUS_WON;
+    } else if (game->attempt == WORDLE_MAX_ATTEMPTS) {
+        game->status = WORDLE_STATUS_LOST;
+    }
+
+    return WORDLE_GUESS_ACCEPTED;
+}
+
+
+Wordle_Status wordle_game_status(const Wordle_Game *game)
+{
+    return game->status;
+}
+
+
+const char *wordle_answer(const Wordle_Game *game)
+{
+    return words[game->answer];
+}
+
+
+void wordle_game_guess(const Wordle_Game *game, int attempt, char guess[WORD_LEN])
+{
+    wordle_unpack_word(game->guesses[attempt], guess);
+}
+
+
+void wordle_game_feedback(const Wordle_Game *game, int attempt, Wordle_Feedback feedback[WORD_LEN])
+{
+    wordle_pattern_feedback(game->patterns[attempt], feedback);
+}
+
+
+/* Colors a guess against the hidden word. Letters in the right place are
+ * matched first, the rest are matched left to right against the letters
+ * of the hidden word that are still unmatched. */
+void wordle_score(const char *guess, const char *answer, Wordle_Feedback feedback[WORD_LEN])
+{
+    char word_buffer[WORD_LEN] = {0};
+    char guess_buffer[WORD_LEN] = {0};
+    for (int i = 0; i < WORD_LEN; ++i) {
+        word_buffer[i] = answer[i];
+        guess_buffer[i] = guess[i];
+    }
+
+    for (int i = 0; i < WORD_LEN; ++i) {
+        if (guess_buffer[i] == word_buffer[i]) {
+            feedback[i] = WORDLE_FEEDBACK_CORRECT;
+            guess_buffer[i] = '\0';
+            word_buffer[i] = '\0';
+        } else {
+            feedback[i] = WORDLE_FEEDBACK_WRONG;
+        }
+    }
+
+    for (int i = 0; i < WORD_LEN; ++i) {
+        if (word_buffer[i] == '\0') continue;
+        for (int j = 0; j < WORD_LEN; ++j) {
+            if (guess_buffer[j] == '\0') continue;
+            if (word_buffer[i] == guess_buffer[j]) {
+                feedback[j] = WORDLE_FEEDBACK_MISPLACED;
+                guess_buffer[j] = '\0';
+                word_buffer[i] = '\0';
+                break;
+            }
+        }
+    }
+}
+
+
+/* Encodes feedback as a base 3 number, the first letter is the lowest digit */
+int wordle_feedback_pattern(const Wordle_Feedback *feedback)
+{
+    int pattern = 0;
+    for (int i = WORD_LEN - 1; i >= 0; --i) {
+        pattern = pattern*3 + feedback[i];
+    }
+    return pattern;
+}
+
+
+void wordle_pattern_feedback(int pattern, Wordle_Feedback feedback[WORD_LEN])
+{
+    for (int i = 0; i < WORD_LEN; ++i) {
+        feedback[i] = pattern % 3;
+        pattern /= 3;
+    }
+}
+
+
+const char *wordle_word(int index)
+{
+    return words[index];
+}
+
+
+int wordle_find_word(const char *word)
+{
+    int node = WORDLE_TRIE_ROOT;
+    for (int i = 0; i < WORD_LEN; ++i) {
+        node = wordle_trie_step(node, word[i]);
+    }
+    return node < 0 ? -1 : trie[node].first;
+}
+
+
+/* Follows the letter from a trie node, returns -1 if no word continues with it */
+int wordle_trie_step(int node, char chr)
+{
+    if (node < 0) return -1;
+
+    int letter = chr - 'A';
+    if (letter < 0 || letter >= WORDLE_LETTERS) return -1;
+
+    unsigned int letters = trie[node].letters;
+    if ((letters & (1u << letter)) == 0) return -1;
+    return trie[node].first + __builtin_popcount(letters & ((1u << letter) - 1));
+}
+
+
+/* Packs upper case letters into WORDLE_LETTER_BITS each, the first letter in
+ * the lowest bits */
+unsigned int wordle_pack_word(const char *word)
+{
+    unsigned int packed = 0;
+    for (int i = WORD_LEN - 1; i >= 0; --i) {
+        packed = (packed << WORDLE_LETTER_BITS) | ((word[i] - 'A') & ((1u << WORDLE_LETTER_BITS) - 1));
+    }
+    return packed;
+}
+
+
+void wordle_unpack_word(unsigned int packed, char word[WORD_LEN])
+{
+    for (int i = 0; i < WORD_LEN; ++i) {
+        word[i] = 'A' + (packed & ((1u << WORDLE_LETTER_BITS) - 1));
+        packed >>= WORDLE_LETTER_BITS;
+    }
+}
+
+
+void wordle_candidates_reset(Wordle_Candidates *candidates)
+{
+    for (int i = 0; i < WORDS; ++i) {
+        candidates->items[i] = i;
+    }
+    candidates->count = WORDS;
+
+    for (int i = 0; i < WORDLE_MASK_SIZE; ++i) {
+        candidates->mask[i] = 0;
+    }
+    for (int i = 0; i < WORDS; ++i) {
+        candidates->mask[i/64] |= 1ULL << (i%64);
+    }
+    for (int letter = 0; letter < WORDLE_LETTERS; ++letter) {
+        int count = 0;
+        for (int i = 0; i < WORDLE_MASK_SIZE; ++i) {
+            count += __builtin_popcountll(letter_words[letter][i]);
+        }
+        candidates->letter_counts[letter] = count;
+    }
+}
+
+
+static bool is_feedback_equals(const Wordle_Feedback *f1, const Wordle_Feedback *f2)
+{
+    for (int i = 0; i < WORD_LEN; ++i) {
+        if (f1[i] != f2[i]) return false;
+    }
+    return true;
+}
+
+
+/* Keeps only the words that would have produced the same feedback */
+void wordle_candidates_filter(Wordle_Candidates *candidates, const char *guess, const Wordle_Feedback *feedback)
+{
+    unsigned long long previous_mask[WORDLE_MASK_SIZE];
+    for (int i = 0; i < WORDLE_MASK_SIZE; ++i) {
+        previous_mask[i] = candidates->mask[i];
+    }
+
+    Wordle_Feedback candidate_feedback[WORD_LEN];
+    int count = 0;
+    for (int i = 0; i < candidates->count; ++i) {
+        int word = candidates->items[i];
+        wordle_score(guess, words[word], candidate_feedback);
+        if (is_feedback_equals(candidate_feedback, feedback)) {
+            candidates->items[count++] = word;
+        } else {
+            candidates->mask[word/64] &= ~(1ULL << (word%64));
+        }
+    }
+    candidates->count = count;
+
+    /* Only the removed words are subtracted from the letter counts */
+    for (int i = 0; i < WORDLE_MASK_SIZE; ++i) {
+        unsigned long long removed = previous_mask[i] & ~candidates->mask[i];
+        if (removed == 0) continue;
+        for (int letter = 0; letter < WORDLE_LETTERS; ++letter) {
+            candidates->letter_counts[letter] -= __builtin_popcountll(removed & letter_words[letter][i]);
+        }
+    }
+}
+
+
+/* Scores the guess against every candidate and groups them by feedback */
+void wordle_outcomes(const Wordle_Candidates *candidates, const char *guess, Wordle_Outcomes *outcomes)
+{
+    int counts[WORDLE_PATTERNS] = {0};
+    Wordle_Feedback feedback[WORD_LEN];
+    for (int i = 0; i < candidates->count; ++i) {
+        wordle_score(guess, words[candidates->items[i]], feedback);
+        ++counts[wordle_feedback_pattern(feedback)];
+    }
+
+    float sum_of_squares = 0.0f;
+    outcomes->count = 0;
+    for (int pattern = 0; pattern < WORDLE_PATTERNS; ++pattern) {
+        if (counts[pattern] == 0) continue;
+        sum_of_squares += (float)counts[pattern] * counts[pattern];
+
+        /* Insertion sort, there are at most WORDLE_PATTERNS outcomes */
+        int i = outcomes->count++;
+        while (i > 0 && outcomes->items[i - 1].count < counts[pattern]) {
+            outcomes->items[i] = outcomes->items[i - 1];
+            --i;
+        }
+        outcomes->items[i].pattern = pattern;
+        outcomes->items[i].count = counts[pattern];
+    }
+
+    outcomes->expected = candidates->count > 0 ? sum_of_squares / candidates->count : 0.0f;
+}
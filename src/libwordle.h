@@ -0,0 +1,93 @@
+#ifndef LIBWORDLE_H_
+#define LIBWORDLE_H_
+
+#include <stdbool.h>
+
+#include "words.h"
+
+// Rules of Wordle without any rendering. The library does not depend on
+// raylib or libc, so the same code runs in the native and wasm builds and in
+// headless simulations.
+
+#define WORDLE_MAX_ATTEMPTS 6
+#define WORDLE_LETTERS      26
+#define WORDLE_PATTERNS     243 // 3^WORD_LEN possible feedbacks
+#define WORDLE_MASK_SIZE    ((WORDS + 63)/64)
+#define WORDLE_TRIE_ROOT    0
+#define WORDLE_LETTER_BITS  5   // Bits per letter in a packed word
+
+typedef enum Wordle_Feedback {
+    WORDLE_FEEDBACK_WRONG = 0,
+    WORDLE_FEEDBACK_MISPLACED,
+    WORDLE_FEEDBACK_CORRECT,
+} Wordle_Feedback;
+
+typedef enum Wordle_Status {
+    WORDLE_STATUS_PLAYING = 0,
+    WORDLE_STATUS_WON,
+    WORDLE_STATUS_LOST,
+} Wordle_Status;
+
+typedef enum Wordle_Guess_Result {
+    WORDLE_GUESS_ACCEPTED = 0,
+    WORDLE_GUESS_INCOMPLETE,        // Guess is shorter than WORD_LEN
+    WORDLE_GUESS_UNKNOWN_WORD,      // Guess is not in the word list
+    WORDLE_GUESS_GAME_OVER,         // Game is already won or lost
+} Wordle_Guess_Result;
+
+/* Logical state of a game only, small enough that millions of sessions fit
+ * in flat arrays. Anything needed to draw a game belongs to the UI. */
+typedef struct Wordle_Game {
+    unsigned int guesses[WORDLE_MAX_ATTEMPTS];              // Accepted guesses packed by wordle_pack_word
+    int answer;                                             // Index of the hidden word
+    unsigned char patterns[WORDLE_MAX_ATTEMPTS];            // Feedback for accepted guesses as wordle_feedback_pattern
+    unsigned char attempt;                                  // Number of accepted guesses
+    unsigned char status;                                   // Wordle_Status of the game so far
+} Wordle_Game;
+
+_Static_assert(sizeof(Wordle_Game) <= 64, "Wordle_Game must fit in a cache line");
+
+typedef struct Wordle_Candidates {
+    int items[WORDS];                                       // Indices of words consistent with the feedback so far
+    int count;                                              // Number of candidates
+    unsigned long long mask[WORDLE_MASK_SIZE];              // Same set as items as a bit per word
+    int letter_counts[WORDLE_LETTERS];                      // Number of candidates containing each letter
+} Wordle_Candidates;
+
+typedef struct Wordle_Outcome {
+    int pattern;                                            // Feedback encoded by wordle_feedback_pattern
+    int count;                                              // Number of candidates producing that feedback
+} Wordle_Outcome;
+
+typedef struct Wordle_Outcomes {
+    Wordle_Outcome items[WORDLE_PATTERNS];                  // Possible feedbacks of a guess, most likely first
+    int count;                                              // Number of feedbacks produced by at least one candidate
+    float expected;                                         // Expected number of candidates left after the guess
+} Wordle_Outcomes;
+
+/* Game */
+void wordle_new_game(Wordle_Game *game, int answer);
+Wordle_Guess_Result wordle_submit_guess(Wordle_Game *game, const char *guess);
+Wordle_Status wordle_game_status(const Wordle_Game *game);
+const char *wordle_answer(const Wordle_Game *game);
+void wordle_game_guess(const Wordle_Game *game, int attempt, char guess[WORD_LEN]);
+void wordle_game_feedback(const Wordle_Game *game, int attempt, Wordle_Feedback feedback[WORD_LEN]);
+
+/* Scoring */
+void wordle_score(const char *guess, const char *answer, Wordle_Feedback feedback[WORD_LEN]);
+int wordle_feedback_pattern(const Wordle_Feedback *feedback);
+void wordle_pattern_feedback(int pattern, Wordle_Feedback feedback[WORD_LEN]);
+
+/* Word list */
+const char *wordle_word(int index);
+int wordle_find_word(const char *word);
+int wordle_trie_step(int node, char chr);
+unsigned int wordle_pack_word(const char *word);
+void wordle_unpack_word(unsigned int packed, char word[WORD_LEN]);
+
+/* Candidates */
+void wordle_candidates_reset(Wordle_Candidates *candidates);
+void wordle_candidates_filter(Wordle_Candidates *candidates, const char *guess, const Wordle_Feedback *feedback);
+void wordle_outcomes(const Wordle_Candidates *candidates, const char *guess, Wordle_Outcomes *outcomes);
+
+#endif // LIBWORDLE_H_
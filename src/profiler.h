@@ -0,0 +1,169 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+// Timers for the sections of a frame, kept for the last PROFILER_FRAMES
+// frames. They are compiled in only with -DDEBUG or -DPROFILER, otherwise
+// the macros expand to nothing, the ring and its functions are left out and
+// the game does not read the clock at all.
+//
+//     PROFILE_FRAME_BEGIN(dt);
+//     ...
+//     PROFILE_FRAME_END();
+//
+//     PROFILE_BEGIN(PROFILE_DRAW_KEYBOARD);
+//     ...
+//     PROFILE_END(PROFILE_DRAW_KEYBOARD);
+//
+//     PROFILE_SCOPE(PROFILE_MAKE_ATTEMPT) state = make_attempt();
+//
+// #define PROFILER_IMPLEMENTATION in one file before including it.
+
+#if defined(DEBUG) || defined(PROFILER)
+#   define PROFILER_ENABLED
+#endif
+
+#define PROFILER_FRAMES 600
+
+typedef enum Profile_Section {
+    PROFILE_FRAME = 0,              // The whole frame after polling the input
+    PROFILE_UPDATE,
+    PROFILE_MAKE_ATTEMPT,
+    PROFILE_DRAW_ATTEMPTS,
+    PROFILE_DRAW_USER_GUESS,
+    PROFILE_DRAW_KEYBOARD,
+    PROFILE_RENDER_END,             // Replaying the render commands, EndDrawing included
+    PROFILE_SECTIONS,
+} Profile_Section;
+
+typedef struct Profile_Frame {
+    float dt;                               // Seconds since the previous frame
+    float sections[PROFILE_SECTIONS];       // Seconds spent in every section during the frame
+} Profile_Frame;
+
+typedef struct Profiler {
+    Profile_Frame frames[PROFILER_FRAMES];  // Ring of the last frames
+    int count;                              // Frames in the ring
+    int next;                               // Index the next frame goes to
+    Profile_Frame current;                  // Frame being measured
+} Profiler;
+
+#ifdef PROFILER_ENABLED
+extern const char *profile_section_names[PROFILE_SECTIONS];
+
+double profiler_now(void);
+void profiler_add(Profile_Section section, double seconds);
+void profiler_frame_begin(float dt);
+void profiler_frame_end(void);
+int profiler_frames_count(void);
+const Profile_Frame *profiler_frame(int index);
+bool profiler_export_csv(const char *path);
+
+#   define PROFILE_FRAME_BEGIN(dt) profiler_frame_begin(dt)
+#   define PROFILE_FRAME_END()     profiler_frame_end()
+#   define PROFILE_BEGIN(section) double profile_start_##section = profiler_now()
+#   define PROFILE_END(section)   profiler_add((section), profiler_now() - profile_start_##section)
+#   define PROFILE_SCOPE(section) \
+        for (double profile_start = profiler_now(), profile_once = 1; profile_once; \
+             profile_once = 0, profiler_add((section), profiler_now() - profile_start))
+#else
+#   define PROFILE_FRAME_BEGIN(dt)
+#   define PROFILE_FRAME_END()
+#   define PROFILE_BEGIN(section)
+#   define PROFILE_END(section)
+#   define PROFILE_SCOPE(section)
+#endif
+
+#endif // PROFILER_H_
+
+#if defined(PROFILER_IMPLEMENTATION) && defined(PROFILER_ENABLED)
+
+const char *profile_section_names[PROFILE_SECTIONS] = {
+    [PROFILE_FRAME]           = "frame",
+    [PROFILE_UPDATE]          = "update",
+    [PROFILE_MAKE_ATTEMPT]    = "make_attempt",
+    [PROFILE_DRAW_ATTEMPTS]   = "draw_attempts",
+    [PROFILE_DRAW_USER_GUESS] = "draw_user_guess",
+    [PROFILE_DRAW_KEYBOARD]   = "draw_keyboard",
+    [PROFILE_RENDER_END]      = "render_end",
+};
+
+static Profiler profiler = {0};
+
+
+#ifdef PLATFORM_WEB
+double profiler_now(void)
+{
+    return GetTime();
+}
+#else
+double profiler_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+#endif
+
+
+void profiler_add(Profile_Section section, double seconds)
+{
+    profiler.current.sections[section] += seconds;
+}
+
+
+void profiler_frame_begin(float dt)
+{
+    profiler.current = (Profile_Frame) {0};
+    profiler.current.dt = dt;
+}
+
+
+void profiler_frame_end(void)
+{
+    profiler.frames[profiler.next] = profiler.current;
+    profiler.next = (profiler.next + 1) % PROFILER_FRAMES;
+    if (profiler.count < PROFILER_FRAMES) profiler.count += 1;
+}
+
+
+int profiler_frames_count(void)
+{
+    return profiler.count;
+}
+
+
+/* Frames are indexed from the oldest one */
+const Profile_Frame *profiler_frame(int index)
+{
+    int first = (profiler.next - profiler.count + PROFILER_FRAMES) % PROFILER_FRAMES;
+    return &profiler.frames[(first + index) % PROFILER_FRAMES];
+}
+
+
+#ifdef PLATFORM_WEB
+bool profiler_export_csv(const char *path)
+{
+    (void) path;
+    return false;
+}
+#else
+/* One row per frame with the times in microseconds */
+bool profiler_export_csv(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL) return false;
+
+    fprintf(file, "frame,dt");
+    for (int i = 0; i < PROFILE_SECTIONS; ++i) fprintf(file, ",%s", profile_section_names[i]);
+    fprintf(file, "\n");
+    for (int i = 0; i < profiler.count; ++i) {
+        const Profile_Frame *frame = profiler_frame(i);
+        fprintf(file, "%d,%.1f", i, frame->dt * 1e6);
+        for (int j = 0; j < PROFILE_SECTIONS; ++j) fprintf(file, ",%.1f", frame->sections[j] * 1e6);
+        fprintf(file, "\n");
+    }
+    return fclose(file) == 0;
+}
+#endif // PLATFORM_WEB
+
+#endif // PROFILER_IMPLEMENTATION && PROFILER_ENABLED
@@ -0,0 +1,450 @@
+#ifndef RENDER_H_
+#define RENDER_H_
+
+#include "raylib.h"
+
+// Drawing of the game goes into a buffer of commands that a backend replays
+// at the end of the frame:
+//  - raylib draws them natively,
+//  - js/raylib.js draws all of them in one call from the wasm build,
+//  - the null backend drops them, so tools that run the game without a
+//    window measure only the cost of the game itself,
+//  - the software backend rasterizes them into an RGBA image on the CPU, so
+//    frames can be compared with golden images without a display.
+// The backend follows the platform, -DRENDER_BACKEND_NULL forces the null one
+// and -DRENDER_BACKEND_SOFTWARE the software one.
+//
+// Texts are copied into the buffer, so they may live on the stack of the
+// caller. Measuring text is answered right away by the backend.
+//
+// #define RENDER_IMPLEMENTATION in one file before including it.
+
+#if defined(PLATFORM_HEADLESS) && !defined(RENDER_BACKEND_NULL) && !defined(RENDER_BACKEND_SOFTWARE)
+#   define RENDER_BACKEND_NULL
+#endif
+
+#define RENDER_MAX_COMMANDS 2048
+#define RENDER_MAX_TEXT     (16*1024)
+
+typedef enum Render_Kind {
+    RENDER_CLEAR = 0,
+    RENDER_RECTANGLE,
+    RENDER_RECTANGLE_LINES,
+    RENDER_RECTANGLE_ROUNDED,
+    RENDER_RECTANGLE_ROUNDED_LINES,
+    RENDER_TEXT,
+} Render_Kind;
+
+/* Nine 4 byte fields, js/raylib.js reads them by these offsets */
+typedef struct Render_Command {
+    int kind;                       // Render_Kind
+    Color color;
+    Rectangle rect;                 // Only x and y for text
+    float roundness;                // Font size for text
+    float thickness;                // Spacing for text
+    int text;                       // Offset of the text in Render_Buffer.text
+} Render_Command;
+
+_Static_assert(sizeof(Render_Command) == 36, "js/raylib.js expects 36 byte render commands");
+
+typedef struct Render_Buffer {
+    Render_Command commands[RENDER_MAX_COMMANDS];
+    int count;                      // Commands recorded this frame
+    char text[RENDER_MAX_TEXT];     // Zero terminated texts of the commands
+    int text_size;                  // Bytes of text used this frame
+    int dropped;                    // Commands that did not fit this frame
+    Font font;                      // Font of every text
+} Render_Buffer;
+
+void render_set_font(Font font);
+void render_begin(void);
+void render_end(void);
+void render_clear(Color color);
+void render_rectangle(int x, int y, int width, int height, Color color);
+void render_rectangle_lines(int x, int y, int width, int height, Color color);
+void render_rectangle_rounded(Rectangle rec, float roundness, Color color);
+void render_rectangle_rounded_lines(Rectangle rec, float roundness, float thickness, Color color);
+void render_text(const char *text, Vector2 position, float font_size, float spacing, Color color);
+Vector2 render_measure_text(const char *text, float font_size, float spacing);
+const Render_Buffer *render_buffer(void);
+
+#ifdef RENDER_BACKEND_SOFTWARE
+Font render_software_load_font(const char *file_name, int font_size);
+void render_software_unload_font(Font font);
+void render_software_set_target(Image *image);
+#endif
+
+#endif // RENDER_H_
+
+#ifdef RENDER_IMPLEMENTATION
+
+#ifdef PLATFORM_WEB
+    extern void render_js_flush(const Render_Command *commands, int count, const char *text, const Font *font);
+#endif
+
+static Render_Buffer render = {0};
+
+
+void render_set_font(Font font)
+{
+    render.font = font;
+}
+
+
+const Render_Buffer *render_buffer(void)
+{
+    return &render;
+}
+
+
+void render_begin(void)
+{
+    render.count = 0;
+    render.text_size = 0;
+    render.dropped = 0;
+}
+
+
+static Render_Command *render_push(Render_Kind kind, Color color)
+{
+    if (render.count >= RENDER_MAX_COMMANDS) {
+        render.dropped += 1;
+        return NULL;
+    }
+    Render_Command *command = &render.commands[render.count++];
+    command->kind = kind;
+    command->color = color;
+    return command;
+}
+
+
+void render_clear(Color color)
+{
+    render_push(RENDER_CLEAR, color);
+}
+
+
+void render_rectangle(int x, int y, int width, int height, Color color)
+{
+    Render_Command *command = render_push(RENDER_RECTANGLE, color);
+    if (command != NULL) command->rect = (Rectangle) { x, y, width, height };
+}
+
+
+void render_rectangle_lines(int x, int y, int width, int height, Color color)
+{
+    Render_Command *command = render_push(RENDER_RECTANGLE_LINES, color);
+    if (command != NULL) command->rect = (Rectangle) { x, y, width, height };
+}
+
+
+void render_rectangle_rounded(Rectangle rec, float roundness, Color color)
+{
+    Render_Command *command = render_push(RENDER_RECTANGLE_ROUNDED, color);
+    if (command == NULL) return;
+    command->rect = rec;
+    command->roundness = roundness;
+}
+
+
+void render_rectangle_rounded_lines(Rectangle rec, float roundness, float thickness, Color color)
+{
+    Render_Command *command = render_push(RENDER_RECTANGLE_ROUNDED_LINES, color);
+    if (command == NULL) return;
+    command->rect = rec;
+    command->roundness = roundness;
+    command->thickness = thickness;
+}
+
+
+void render_text(const char *text, Vector2 position, float font_size, float spacing, Color color)
+{
+    int len = 0;
+    while (text[len] != '\0') ++len;
+    if (render.text_size + len + 1 > RENDER_MAX_TEXT) {
+        render.dropped += 1;
+        return;
+    }
+
+    Render_Command *command = render_push(RENDER_TEXT, color);
+    if (command == NULL) return;
+    command->rect = (Rectangle) { position.x, position.y, 0, 0 };
+    command->roundness = font_size;
+    command->thickness = spacing;
+    command->text = render.text_size;
+    for (int i = 0; i <= len; ++i) render.text[render.text_size++] = text[i];
+}
+
+
+#if defined(RENDER_BACKEND_NULL)
+
+/* Every glyph is taken as half of the font size wide, there is no font to
+ * measure without a window */
+Vector2 render_measure_text(const char *text, float font_size, float spacing)
+{
+    int len = 0;
+    while (text[len] != '\0') ++len;
+    return CLITERAL(Vector2){ len * (font_size/2 + spacing), font_size };
+}
+
+
+void render_end(void)
+{
+}
+
+#elif defined(PLATFORM_WEB)
+
+Vector2 render_measure_text(const char *text, float font_size, float spacing)
+{
+    return MeasureTextEx(render.font, text, font_size, spacing);
+}
+
+
+void render_end(void)
+{
+    BeginDrawing();
+    render_js_flush(render.commands, render.count, render.text, &render.font);
+    EndDrawing();
+}
+
+#elif defined(RENDER_BACKEND_SOFTWARE)
+
+static Image *render_target = NULL;
+
+
+/* Loads the glyphs of a font without a GPU, the Font has no texture but it
+ * measures text like the one from LoadFontEx */
+Font render_software_load_font(const char *file_name, int font_size)
+{
+    Font font = {0};
+    int data_size = 0;
+    unsigned char *data = LoadFileData(file_name, &data_size);
+    if (data == NULL) return font;
+
+    font.baseSize = font_size;
+    font.glyphCount = 95;
+    font.glyphs = LoadFontData(data, data_size, font_size, NULL, font.glyphCount, FONT_DEFAULT);
+    UnloadFileData(data);
+    if (font.glyphs == NULL) return (Font) {0};
+
+    /* Only the rectangles of the glyphs are needed, the atlas itself is not */
+    Image atlas = GenImageFontAtlas(font.glyphs, &font.recs, font.glyphCount, font_size, 4, 0);
+    UnloadImage(atlas);
+    return font;
+}
+
+
+void render_software_unload_font(Font font)
+{
+    UnloadFontData(font.glyphs, font.glyphCount);
+    MemFree(font.recs);
+}
+
+
+/* Commands are rasterized into the image at render_end, it has to be in
+ * PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 */
+void render_software_set_target(Image *image)
+{
+    render_target = image;
+}
+
+
+Vector2 render_measure_text(const char *text, float font_size, float spacing)
+{
+    if (render.font.glyphs == NULL) {
+        int len = 0;
+        while (text[len] != '\0') ++len;
+        return CLITERAL(Vector2){ len * (font_size/2 + spacing), font_size };
+    }
+    return MeasureTextEx(render.font, text, font_size, spacing);
+}
+
+
+static void render_software_blend(int x, int y, Color color, int coverage)
+{
+    if (x < 0 || y < 0 || x >= render_target->width || y >= render_target->height) return;
+    unsigned char *pixel = (unsigned char *) render_target->data + (y * render_target->width + x) * 4;
+    int alpha = color.a * coverage / 255;
+    pixel[0] = (color.r * alpha + pixel[0] * (255 - alpha)) / 255;
+    pixel[1] = (color.g * alpha + pixel[1] * (255 - alpha)) / 255;
+    pixel[2] = (color.b * alpha + pixel[2] * (255 - alpha)) / 255;
+    pixel[3] = alpha + pixel[3] * (255 - alpha) / 255;
+}
+
+
+static void render_software_rectangle(int x, int y, int width, int height, Color color)
+{
+    int x0 = x < 0 ? 0 : x;
+    int y0 = y < 0 ? 0 : y;
+    int x1 = x + width > render_target->width ? render_target->width : x + width;
+    int y1 = y + height > render_target->height ? render_target->height : y + height;
+    for (int py = y0; py < y1; ++py) {
+        for (int px = x0; px < x1; ++px) render_software_blend(px, py, color, 255);
+    }
+}
+
+
+/* Whether the center of the pixel is inside the rectangle with corners of
+ * the given radius */
+static bool render_software_inside_rounded(int px, int py, Rectangle rect, float radius)
+{
+    float x = px + 0.5f;
+    float y = py + 0.5f;
+    if (x < rect.x || y < rect.y || x >= rect.x + rect.width || y >= rect.y + rect.height) return false;
+
+    float cx = x < rect.x + radius ? rect.x + radius : x > rect.x + rect.width - radius ? rect.x + rect.width - radius : x;
+    float cy = y < rect.y + radius ? rect.y + radius : y > rect.y + rect.height - radius ? rect.y + rect.height - radius : y;
+    return (x - cx)*(x - cx) + (y - cy)*(y - cy) <= radius*radius;
+}
+
+
+/* Fills the pixels inside outer and outside inner, pass an empty inner to
+ * fill the whole shape. Radii follow DrawRectangleRounded. */
+static void render_software_rounded(Rectangle outer, float outer_radius, Rectangle inner, float inner_radius, Color color)
+{
+    int x0 = outer.x < 0 ? 0 : outer.x;
+    int y0 = outer.y < 0 ? 0 : outer.y;
+    int x1 = outer.x + outer.width + 1 > render_target->width ? render_target->width : outer.x + outer.width + 1;
+    int y1 = outer.y + outer.height + 1 > render_target->height ? render_target->height : outer.y + outer.height + 1;
+    for (int py = y0; py < y1; ++py) {
+        for (int px = x0; px < x1; ++px) {
+            if (!render_software_inside_rounded(px, py, outer, outer_radius)) continue;
+            if (render_software_inside_rounded(px, py, inner, inner_radius)) continue;
+            render_software_blend(px, py, color, 255);
+        }
+    }
+}
+
+
+static float render_software_radius(Rectangle rect, float roundness)
+{
+    float side = rect.width < rect.height ? rect.width : rect.height;
+    return roundness <= 0.0f ? 0.0f : (roundness >= 1.0f ? side : side * roundness) / 2;
+}
+
+
+/* Glyphs are scaled down from the size they were loaded at by averaging the
+ * pixels a target pixel covers, with the same layout as DrawTextEx */
+static void render_software_text(const char *text, Vector2 position, float font_size, float spacing, Color color)
+{
+    Font font = render.font;
+    if (font.glyphs == NULL) return;
+
+    float scale = font_size / font.baseSize;
+    float offset = 0.0f;
+    for (int i = 0; text[i] != '\0'; ++i) {
+        int index = GetGlyphIndex(font, (unsigned char) text[i]);
+        GlyphInfo glyph = font.glyphs[index];
+        Image image = glyph.image;
+        if (image.data != NULL && image.format == PIXELFORMAT_UNCOMPRESSED_GRAYSCALE) {
+            int x = position.x + offset + glyph.offsetX * scale;
+            int y = position.y + glyph.offsetY * scale;
+            int width = image.width * scale;
+            int height = image.height * scale;
+            for (int dy = 0; dy < height; ++dy) {
+                int sy0 = dy / scale;
+                int sy1 = (dy + 1) / scale;
+                if (sy1 <= sy0) sy1 = sy0 + 1;
+                if (sy1 > image.height) sy1 = image.height;
+                for (int dx = 0; dx < width; ++dx) {
+                    int sx0 = dx / scale;
+                    int sx1 = (dx + 1) / scale;
+                    if (sx1 <= sx0) sx1 = sx0 + 1;
+                    if (sx1 > image.width) sx1 = image.width;
+                    int sum = 0;
+                    for (int sy = sy0; sy < sy1; ++sy) {
+                        for (int sx = sx0; sx < sx1; ++sx) sum += ((unsigned char *) image.data)[sy * image.width + sx];
+                    }
+                    int coverage = sum / ((sy1 - sy0) * (sx1 - sx0));
+                    if (coverage > 0) render_software_blend(x + dx, y + dy, color, coverage);
+                }
+            }
+        }
+        float advance = glyph.advanceX == 0 ? font.recs[index].width : glyph.advanceX;
+        offset += advance * scale + spacing;
+    }
+}
+
+
+void render_end(void)
+{
+    if (render_target == NULL) return;
+
+    for (int i = 0; i < render.count; ++i) {
+        const Render_Command *command = &render.commands[i];
+        Rectangle rect = command->rect;
+        switch ((Render_Kind) command->kind) {
+            case RENDER_CLEAR: {
+                for (int j = 0; j < render_target->width * render_target->height; ++j) {
+                    ((Color *) render_target->data)[j] = command->color;
+                }
+            } break;
+            case RENDER_RECTANGLE: {
+                render_software_rectangle(rect.x, rect.y, rect.width, rect.height, command->color);
+            } break;
+            case RENDER_RECTANGLE_LINES: {
+                render_software_rectangle(rect.x, rect.y, rect.width, 1, command->color);
+                render_software_rectangle(rect.x, rect.y + rect.height - 1, rect.width, 1, command->color);
+                render_software_rectangle(rect.x, rect.y + 1, 1, rect.height - 2, command->color);
+                render_software_rectangle(rect.x + rect.width - 1, rect.y + 1, 1, rect.height - 2, command->color);
+            } break;
+            case RENDER_RECTANGLE_ROUNDED: {
+                render_software_rounded(rect, render_software_radius(rect, command->roundness), (Rectangle) {0}, 0.0f, command->color);
+            } break;
+            case RENDER_RECTANGLE_ROUNDED_LINES: {
+                /* Like DrawRectangleRoundedLinesEx the lines are drawn around the rectangle */
+                float thickness = command->thickness;
+                float radius = render_software_radius(rect, command->roundness);
+                Rectangle outer = { rect.x - thickness, rect.y - thickness, rect.width + thickness*2, rect.height + thickness*2 };
+                render_software_rounded(outer, radius + thickness, rect, radius, command->color);
+            } break;
+            case RENDER_TEXT: {
+                Vector2 position = { rect.x, rect.y };
+                render_software_text(render.text + command->text, position, command->roundness, command->thickness, command->color);
+            } break;
+        }
+    }
+}
+
+#else
+
+Vector2 render_measure_text(const char *text, float font_size, float spacing)
+{
+    return MeasureTextEx(render.font, text, font_size, spacing);
+}
+
+
+void render_end(void)
+{
+    BeginDrawing();
+    for (int i = 0; i < render.count; ++i) {
+        const Render_Command *command = &render.commands[i];
+        Rectangle rect = command->rect;
+        switch ((Render_Kind) command->kind) {
+            case RENDER_CLEAR: {
+                ClearBackground(command->color);
+            } break;
+            case RENDER_RECTANGLE: {
+                DrawRectangle(rect.x, rect.y, rect.width, rect.height, command->color);
+            } break;
+            case RENDER_RECTANGLE_LINES: {
+                DrawRectangleLines(rect.x, rect.y, rect.width, rect.height, command->color);
+            } break;
+            case RENDER_RECTANGLE_ROUNDED: {
+                DrawRectangleRounded(rect, command->roundness, 0, command->color);
+            } break;
+            case RENDER_RECTANGLE_ROUNDED_LINES: {
+                DrawRectangleRoundedLinesEx(rect, command->roundness, 0, command->thickness, command->color);
+            } break;
+            case RENDER_TEXT: {
+                Vector2 position = { rect.x, rect.y };
+                DrawTextEx(render.font, render.text + command->text, position, command->roundness, command->thickness, command->color);
+            } break;
+        }
+    }
+    EndDrawing();
+}
+
+#endif // RENDER_BACKEND_NULL
+
+#endif // RENDER_IMPLEMENTATION
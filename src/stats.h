@@ -0,0 +1,288 @@
+#ifndef STATS_H_
+#define STATS_H_
+
+#include <stdbool.h>
+
+#include "libwordle.h"
+
+// Statistics of finished games. Every game is appended to a log as an 8 byte
+// record and the totals are kept in a snapshot that covers a prefix of the
+// log. Loading reads the snapshot and at most STATS_COMPACT_RECORDS records
+// after it, so it does not depend on how many games were ever played.
+//
+// The files live in $XDG_DATA_HOME/wordle or ~/.local/share/wordle. The wasm
+// build has no file system and keeps the statistics of the session only.
+//
+// #define STATS_IMPLEMENTATION in one file before including it.
+
+#define STATS_MAGIC           0x54535257 // "WRST"
+#define STATS_VERSION         1
+#define STATS_COMPACT_RECORDS 64         // Log records after the snapshot that trigger a compaction
+#define STATS_LOG_FILE_NAME      "stats.log"
+#define STATS_SNAPSHOT_FILE_NAME "stats.snapshot"
+
+typedef struct Stats_Record {
+    unsigned int time;                                      // Unix time the game finished
+    unsigned short answer;                                  // Index of the hidden word
+    unsigned char attempts;                                 // Accepted guesses
+    unsigned char won;                                      // 1 if the last guess was the answer
+} Stats_Record;
+
+_Static_assert(sizeof(Stats_Record) == 8, "Stats_Record is stored as is");
+_Static_assert(WORDS <= 0xFFFF, "Stats_Record.answer must fit every word index");
+
+/* Aggregate of the log up to log_records, stored as is in the snapshot file */
+typedef struct Stats {
+    unsigned int magic;                                     // STATS_MAGIC
+    unsigned int version;                                   // STATS_VERSION
+    unsigned int log_records;                               // Records of the log folded into the totals
+    unsigned int played;                                    // Finished games
+    unsigned int won;                                       // Won games
+    unsigned int current_streak;                            // Games won in a row up to the last one
+    unsigned int max_streak;                                // Longest run of won games
+    unsigned int distribution[WORDLE_MAX_ATTEMPTS];         // Won games by the number of guesses
+} Stats;
+
+void stats_init(Stats *stats);
+void stats_add(Stats *stats, Stats_Record record);
+bool stats_load(Stats *stats);
+bool stats_record_game(Stats *stats, const Wordle_Game *game, unsigned int time);
+bool stats_compact(const Stats *stats);
+
+#endif // STATS_H_
+
+#ifdef STATS_IMPLEMENTATION
+
+void stats_init(Stats *stats)
+{
+    *stats = (Stats) {0};
+    stats->magic = STATS_MAGIC;
+    stats->version = STATS_VERSION;
+}
+
+
+static Stats_Record stats_game_record(const Wordle_Game *game, unsigned int time)
+{
+    Stats_Record record = {
+        .time = time,
+        .answer = game->answer,
+        .attempts = game->attempt,
+        .won = game->status == WORDLE_STATUS_WON,
+    };
+    return record;
+}
+
+
+void stats_add(Stats *stats, Stats_Record record)
+{
+    stats->log_records += 1;
+    stats->played += 1;
+    if (record.won) {
+        stats->won += 1;
+        stats->current_streak += 1;
+        if (stats->current_streak > stats->max_streak) stats->max_streak = stats->current_streak;
+        if (record.attempts >= 1 && record.attempts <= WORDLE_MAX_ATTEMPTS) {
+            stats->distribution[record.attempts - 1] += 1;
+        }
+    } else {
+        stats->current_streak = 0;
+    }
+}
+
+
+#ifdef PLATFORM_WEB
+
+bool stats_load(Stats *stats)
+{
+    stats_init(stats);
+    return true;
+}
+
+
+bool stats_record_game(Stats *stats, const Wordle_Game *game, unsigned int time)
+{
+    stats_add(stats, stats_game_record(game, time));
+    return true;
+}
+
+
+bool stats_compact(const Stats *stats)
+{
+    (void) stats;
+    return true;
+}
+
+#else
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static char stats_dir[4096] = {0};
+
+
+/* Finds and creates the directory of the statistics files */
+static bool stats_find_dir(void)
+{
+    if (stats_dir[0] != '\0') return true;
+
+    const char *data_home = getenv("XDG_DATA_HOME");
+    const char *home = getenv("HOME");
+    char parent[sizeof(stats_dir)];
+    if (data_home != NULL && data_home[0] != '\0') {
+        snprintf(parent, sizeof(parent), "%s", data_home);
+    } else if (home != NULL && home[0] != '\0') {
+        snprintf(parent, sizeof(parent), "%s/.local/share", home);
+    } else {
+        return false;
+    }
+
+    /* Only the last two levels are created, the rest is expected to exist */
+    if (mkdir(parent, 0755) < 0 && errno != EEXIST) return false;
+    int len = snprintf(stats_dir, sizeof(stats_dir), "%s/wordle", parent);
+    if (len < 0 || len >= (int) sizeof(stats_dir) - 32) {
+        stats_dir[0] = '\0';
+        return false;
+    }
+    if (mkdir(stats_dir, 0755) < 0 && errno != EEXIST) {
+        stats_dir[0] = '\0';
+        return false;
+    }
+    return true;
+}
+
+
+static const char *stats_path(char *buffer, size_t size, const char *file_name)
+{
+    snprintf(buffer, size, "%s/%s", stats_dir, file_name);
+    return buffer;
+}
+
+
+/* Maps the snapshot instead of reading it, it is a single struct that is
+ * valid as soon as the magic, the version and the size match */
+static bool stats_load_snapshot(Stats *stats)
+{
+    char path[sizeof(stats_dir) + 32];
+    int fd = open(stats_path(path, sizeof(path), STATS_SNAPSHOT_FILE_NAME), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size != sizeof(Stats)) {
+        close(fd);
+        return false;
+    }
+    const Stats *mapped = mmap(NULL, sizeof(Stats), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return false;
+
+    bool valid = mapped->magic == STATS_MAGIC && mapped->version == STATS_VERSION;
+    if (valid) *stats = *mapped;
+    munmap((void *) mapped, sizeof(Stats));
+    return valid;
+}
+
+
+/* Folds the records the snapshot does not cover yet. A torn record at the end
+ * of the log, left by a crash during an append, is cut off so the next
+ * append starts on a record boundary again. */
+static void stats_replay_log(Stats *stats)
+{
+    char path[sizeof(stats_dir) + 32];
+    int fd = open(stats_path(path, sizeof(path), STATS_LOG_FILE_NAME), O_RDWR);
+    if (fd < 0) return;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return;
+    }
+    unsigned int records = st.st_size / sizeof(Stats_Record);
+    if (st.st_size % sizeof(Stats_Record) != 0) (void) !ftruncate(fd, (off_t) records * sizeof(Stats_Record));
+    /* The log was removed or replaced, the snapshot describes another one */
+    if (records < stats->log_records) stats_init(stats);
+
+    Stats_Record batch[256];
+    off_t offset = (off_t) stats->log_records * sizeof(Stats_Record);
+    while (stats->log_records < records) {
+        unsigned int count = records - stats->log_records;
+        if (count > sizeof(batch)/sizeof(batch[0])) count = sizeof(batch)/sizeof(batch[0]);
+        ssize_t n = pread(fd, batch, count * sizeof(Stats_Record), offset);
+        if (n <= 0) break;
+        for (unsigned int i = 0; i < n / sizeof(Stats_Record); ++i) stats_add(stats, batch[i]);
+        offset += n;
+    }
+    close(fd);
+}
+
+
+bool stats_load(Stats *stats)
+{
+    stats_init(stats);
+    if (!stats_find_dir()) return false;
+
+    unsigned int snapshot_records = 0;
+    if (stats_load_snapshot(stats)) snapshot_records = stats->log_records;
+    stats_replay_log(stats);
+    if (stats->log_records - snapshot_records >= STATS_COMPACT_RECORDS) stats_compact(stats);
+    return true;
+}
+
+
+/* Writes the snapshot next to the old one and renames it over, so a crash
+ * leaves either the old or the new snapshot and never a partial one */
+bool stats_compact(const Stats *stats)
+{
+    if (!stats_find_dir()) return false;
+
+    char path[sizeof(stats_dir) + 32];
+    char temp_path[sizeof(stats_dir) + 32];
+    stats_path(path, sizeof(path), STATS_SNAPSHOT_FILE_NAME);
+    stats_path(temp_path, sizeof(temp_path), STATS_SNAPSHOT_FILE_NAME ".tmp");
+
+    int fd = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    bool ok = write(fd, stats, sizeof(*stats)) == sizeof(*stats) && fsync(fd) == 0;
+    close(fd);
+    if (!ok || rename(temp_path, path) < 0) {
+        unlink(temp_path);
+        return false;
+    }
+    return true;
+}
+
+
+/* Appends the finished game to the log with a single write, so games
+ * finished by several running instances append whole records, and compacts
+ * once enough have piled up */
+bool stats_record_game(Stats *stats, const Wordle_Game *game, unsigned int time)
+{
+    Stats_Record record = stats_game_record(game, time);
+    stats_add(stats, record);
+    if (stats_dir[0] == '\0') return true; // Games are saved only after stats_load found the directory
+
+    char path[sizeof(stats_dir) + 32];
+    int fd = open(stats_path(path, sizeof(path), STATS_LOG_FILE_NAME), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) return false;
+    bool ok = write(fd, &record, sizeof(record)) == sizeof(record);
+    struct stat st;
+    if (ok && fstat(fd, &st) == 0 && st.st_size / sizeof(Stats_Record) != stats->log_records) {
+        /* Another instance appended games too, count them from the files */
+        close(fd);
+        return stats_load(stats);
+    }
+    close(fd);
+    if (!ok) return false;
+
+    if (stats->log_records % STATS_COMPACT_RECORDS == 0) return stats_compact(stats);
+    return true;
+}
+
+#endif // PLATFORM_WEB
+
+#endif // STATS_IMPLEMENTATION
@@ -0,0 +1,215 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdbool.h>
+
+// Spans and counters in the Chrome trace event format, to look at frame
+// pacing and startup in chrome://tracing or https://ui.perfetto.dev.
+//
+//     TRACE_BEGIN(game_frame);
+//     ...
+//     TRACE_END(game_frame);
+//
+//     TRACE_SCOPE("make_attempt") state = make_attempt();
+//     trace_counter("render_commands", count);
+//
+// Unlike profiler.h it is compiled into every build. An event costs two reads
+// of the clock and a store into a ring buffer of the thread that emits it,
+// without locks, and the rings keep the last TRACE_RING_EVENTS events of every
+// thread. trace_dump writes them as JSON. Names must be string literals, the
+// events keep the pointers and the names are written without escaping.
+//
+// A dump reads the rings of other threads while they may still write, so it
+// is exact only for the thread that calls it. The wasm build has one thread
+// and no file system, it records events but cannot dump them.
+//
+// #define TRACE_IMPLEMENTATION in one file before including it.
+
+#define TRACE_MAX_THREADS 64
+
+#ifdef PLATFORM_WEB
+#   define TRACE_RING_EVENTS  (1 << 10)  // Events kept per thread, a power of two
+#   define TRACE_THREAD_LOCAL
+#else
+#   define TRACE_RING_EVENTS  (1 << 16)
+#   define TRACE_THREAD_LOCAL _Thread_local
+#endif
+
+typedef enum Trace_Kind {
+    TRACE_SPAN = 0,                 // "X" complete event
+    TRACE_COUNTER,                  // "C" counter event
+} Trace_Kind;
+
+typedef struct Trace_Event {
+    const char *name;
+    unsigned long long start;       // Nanoseconds since the first event
+    unsigned long long duration;    // Nanoseconds, spans only
+    double value;                   // Counters only
+    Trace_Kind kind;
+} Trace_Event;
+
+typedef struct Trace_Ring {
+    Trace_Event events[TRACE_RING_EVENTS];
+    unsigned long long written;     // Events ever written, the ring keeps the last TRACE_RING_EVENTS
+    int thread;                     // tid of the events in the trace
+} Trace_Ring;
+
+unsigned long long trace_now(void);
+void trace_span(const char *name, unsigned long long start, unsigned long long end);
+void trace_counter(const char *name, double value);
+bool trace_dump(const char *path);
+
+#define TRACE_BEGIN(id) unsigned long long trace_start_##id = trace_now()
+#define TRACE_END(id)   trace_span(#id, trace_start_##id, trace_now())
+#define TRACE_SCOPE(name) \
+    for (unsigned long long trace_start = trace_now(), trace_once = 1; trace_once; \
+         trace_once = 0, trace_span((name), trace_start, trace_now()))
+
+#endif // TRACE_H_
+
+#ifdef TRACE_IMPLEMENTATION
+
+#ifdef PLATFORM_WEB
+
+static Trace_Ring trace_main_ring = { .thread = 1 };
+
+
+unsigned long long trace_now(void)
+{
+    return GetTime() * 1e9;
+}
+
+
+static Trace_Ring *trace_thread_ring(void)
+{
+    return &trace_main_ring;
+}
+
+
+bool trace_dump(const char *path)
+{
+    (void) path;
+    return false;
+}
+
+#else
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static TRACE_THREAD_LOCAL Trace_Ring *trace_ring = NULL;
+static Trace_Ring *trace_rings[TRACE_MAX_THREADS] = {0};
+static int trace_rings_count = 0;
+static unsigned long long trace_epoch = 0;
+
+
+unsigned long long trace_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    unsigned long long now = (unsigned long long) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    unsigned long long epoch = __atomic_load_n(&trace_epoch, __ATOMIC_RELAXED);
+    if (epoch == 0) {
+        __atomic_compare_exchange_n(&trace_epoch, &epoch, now, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        epoch = __atomic_load_n(&trace_epoch, __ATOMIC_RELAXED);
+    }
+    return now > epoch ? now - epoch : 0;
+}
+
+
+/* The ring of a thread is allocated by its first event and published for
+ * trace_dump. Threads past TRACE_MAX_THREADS are not traced. */
+static Trace_Ring *trace_thread_ring(void)
+{
+    if (trace_ring != NULL) return trace_ring;
+
+    int index = __atomic_fetch_add(&trace_rings_count, 1, __ATOMIC_RELAXED);
+    if (index >= TRACE_MAX_THREADS) return NULL;
+    Trace_Ring *ring = calloc(1, sizeof(*ring));
+    if (ring == NULL) return NULL;
+    ring->thread = index + 1;
+    __atomic_store_n(&trace_rings[index], ring, __ATOMIC_RELEASE);
+    trace_ring = ring;
+    return ring;
+}
+
+
+static void trace_dump_ring(FILE *file, const Trace_Ring *ring, bool *first)
+{
+    unsigned long long written = __atomic_load_n(&ring->written, __ATOMIC_ACQUIRE);
+    unsigned long long begin = written > TRACE_RING_EVENTS ? written - TRACE_RING_EVENTS : 0;
+    for (unsigned long long i = begin; i < written; ++i) {
+        const Trace_Event *event = &ring->events[i & (TRACE_RING_EVENTS - 1)];
+        fprintf(file, "%s\n", *first ? "" : ",");
+        *first = false;
+        if (event->kind == TRACE_SPAN) {
+            fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    event->name, ring->thread, event->start / 1e3, event->duration / 1e3);
+        } else {
+            fprintf(file, "{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{\"value\":%g}}",
+                    event->name, ring->thread, event->start / 1e3, event->value);
+        }
+    }
+}
+
+
+/* Writes the events of every thread as a JSON array of trace events */
+bool trace_dump(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL) return false;
+
+    bool first = true;
+    fprintf(file, "[");
+    int count = __atomic_load_n(&trace_rings_count, __ATOMIC_RELAXED);
+    if (count > TRACE_MAX_THREADS) count = TRACE_MAX_THREADS;
+    for (int i = 0; i < count; ++i) {
+        const Trace_Ring *ring = __atomic_load_n(&trace_rings[i], __ATOMIC_ACQUIRE);
+        if (ring != NULL) trace_dump_ring(file, ring, &first);
+    }
+    fprintf(file, "\n]\n");
+    return fclose(file) == 0;
+}
+
+#endif // PLATFORM_WEB
+
+
+static void trace_push(Trace_Event event)
+{
+    Trace_Ring *ring = trace_thread_ring();
+    if (ring == NULL) return;
+    unsigned long long written = ring->written;
+    ring->events[written & (TRACE_RING_EVENTS - 1)] = event;
+#ifdef PLATFORM_WEB
+    ring->written = written + 1;
+#else
+    __atomic_store_n(&ring->written, written + 1, __ATOMIC_RELEASE);
+#endif
+}
+
+
+void trace_span(const char *name, unsigned long long start, unsigned long long end)
+{
+    Trace_Event event = {
+        .name = name,
+        .start = start,
+        .duration = end > start ? end - start : 0,
+        .kind = TRACE_SPAN,
+    };
+    trace_push(event);
+}
+
+
+void trace_counter(const char *name, double value)
+{
+    Trace_Event event = {
+        .name = name,
+        .start = trace_now(),
+        .value = value,
+        .kind = TRACE_COUNTER,
+    };
+    trace_push(event);
+}
+
+#endif // TRACE_IMPLEMENTATION
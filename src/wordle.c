@@ -4,15 +4,26 @@
 #include <stdlib.h>
 #include <stddef.h>
 #include <time.h>
+#ifndef PLATFORM_WEB
+#   include <string.h>
+#endif
 
-#include "words.h"
+#include "libwordle.h"
+#define STATS_IMPLEMENTATION
+#include "stats.h"
+#define RENDER_IMPLEMENTATION
+#include "render.h"
+#define PROFILER_IMPLEMENTATION
+#include "profiler.h"
+#define TRACE_IMPLEMENTATION
+#include "trace.h"
 
 
 #ifdef PLATFORM_WEB
     extern void print_word(char *word);
     extern void raylib_js_set_entry(void (*entry)(void));
 #endif
-#define MAX_ATTEMPTS                 6
+#define MAX_ATTEMPTS                 WORDLE_MAX_ATTEMPTS
 #define MAX_RESTART_TIMER            0.5f
 #define MAX_KEY_TIMER                0.25f
 #define MAX_USER_GUESS_CORRECT       1.0f
@@ -21,6 +32,9 @@
 #define USER_GUESS_COLORING_TIME     0.5f
 #define USER_GUESS_APPER_TIME        0.25f
 #define MAX_CURSOR_TIMER             1.0f
+#define MAX_INPUT_KEYS               32
+#define UPDATE_STEP                  (1.0f/120.0f)
+#define MAX_UPDATE_TIME              0.25f      // Longer frames are cut, so a stall is not followed by a burst of updates
 
 #define BACKGROUND_COLOR           ColorFromHSV(0, 0.0f, 0.09f)
 #define LETTER_BOX_COLOR           ColorFromHSV(199, 0.48f, 0.59f)
@@ -32,7 +46,18 @@
 #define DEFAULT_KEYBOARD_KEY_COLOR ColorFromHSV(199, 0.15f, 0.45f)
 #define PRESSED_KEYBOARD_KEY_COLOR ColorBrightness(DEFAULT_KEYBOARD_KEY_COLOR, 0.5f)
 #define WRONG_KEYBOARD_KEY_COLOR   ColorFromHSV(0, 0.0f, 0.25f)
+#define INVALID_BOX_COLOR          ColorLerp(LETTER_BOX_COLOR, RED, 0.4f)
 #define LOSE_BOX_COLOR             ColorFromHSV(0, 0.0f, 0.35f)
+#define HEATMAP_KEY_COLOR          ColorFromHSV(12, 0.65f, 0.75f)
+#define CANDIDATES_PANEL_COLOR     ColorFromHSV(0, 0.0f, 0.13f)
+#define CANDIDATES_SCROLLBAR_COLOR ColorFromHSV(0, 0.0f, 0.30f)
+#define STATS_PANEL_COLOR          ColorAlpha(ColorFromHSV(0, 0.0f, 0.13f), 0.95f)
+#define STATS_BAR_COLOR            WRONG_BOX_COLOR
+#define PROFILER_PANEL_COLOR       ColorAlpha(ColorFromHSV(0, 0.0f, 0.05f), 0.9f)
+#define PROFILER_FAST_COLOR        GREEN_BOX_COLOR
+#define PROFILER_SLOW_COLOR        YELLOW_BOX_COLOR
+#define PROFILER_STALL_COLOR       RED
+#define STATS_LAST_BAR_COLOR       GREEN_BOX_COLOR
 
 #ifdef PLATFORM_WEB
 #   define FONT_SIZE              45
@@ -57,15 +82,32 @@
 #define KEYBOARD_GAP          10
 #define KEYBOARD_FONT_SIZE    (FONT_SIZE - 15)
 #define KEYBOARD_HEIGHT       (KEYBOARD_KEY_SIZE * 3 + KEYBOARD_GAP * 2)
+#define CANDIDATES_WIDTH      140
+#define CANDIDATES_ROW_HEIGHT 26
+#define CANDIDATES_FONT_SIZE  22
+#define CANDIDATES_PADDING    10
+#define CANDIDATES_WHEEL_ROWS 3
+#define CANDIDATES_SCROLL_SPEED 15.0f
+#define CANDIDATES_LIST_HEIGHT (FIELD_HEIGHT - CANDIDATES_ROW_HEIGHT - CANDIDATES_PADDING*2)
+#define STATS_WIDTH           (FIELD_WIDTH + 60)
+#define STATS_PADDING         20
+#define STATS_VALUE_FONT_SIZE 40
+#define STATS_LABEL_FONT_SIZE 18
+#define STATS_BAR_HEIGHT      24
+#define STATS_BAR_GAP         6
+#define PROFILER_WIDTH        320
+#define PROFILER_PADDING      10
+#define PROFILER_FONT_SIZE    16
+#define PROFILER_ROW_HEIGHT   18
+#define PROFILER_BUCKETS      25        // Frame time histogram buckets
+#define PROFILER_BUCKET_MS    2         // Frame time covered by a bucket, the last one takes the rest
+#define PROFILER_GRAPH_HEIGHT 60
+#define PROFILER_CSV_PATH     "profile.csv"
+#define TRACE_DEFAULT_PATH    "trace.json"
 #define SCREEN_WIDTH          PLATFORM_SCREEN_WIDTH
 #define SCREEN_HEIGHT         PLATFORM_SCREEN_HEIGHT
 
 
-typedef struct Attempt {
-    char word[WORD_LEN];
-    Color colors[WORD_LEN];
-} Attempt;
-
 typedef enum State {
     STATE_PLAY = 0,
     STATE_NON_EXISTENT_WORD,
@@ -86,12 +128,11 @@ typedef struct Key {
 typedef struct Char {
     char chr;
     float time;
+    int node;                       // Trie node of the guess up to this letter, -1 if no word starts so
 } Char;
 
 typedef struct Game {
-    char *word;                     // Hidden word
-    int attempt;                    // Current attempt
-    Attempt attempts[MAX_ATTEMPTS]; // Previous attemps
+    Wordle_Game rules;              // Hidden word, previous attempts and their feedback
     Char current_guess[WORD_LEN];   // Current user guess buffer
     int current_guess_len;          // Current user guess buffer length
     State state;                    // Game state
@@ -100,6 +141,26 @@ typedef struct Game {
     bool win;                       // Win
 } Game;
 
+typedef struct Candidates_Panel {
+    float scroll;                   // Current scroll offset of the panel in pixels
+    float scroll_target;            // Scroll offset the panel is moving to
+    bool hidden;                    // Panel is hidden
+} Candidates_Panel;
+
+/* Everything a frame reads from the platform, so that a recorded sequence
+ * of inputs replays the same session */
+typedef struct Input {
+    float dt;                       // Seconds since the previous frame
+    int screen_width;               // Size of the window
+    int screen_height;
+    Vector2 mouse;                  // Mouse position
+    float wheel;                    // Mouse wheel movement this frame
+    bool mouse_pressed;             // Left mouse button was pressed this frame
+    bool shift;                     // Left shift is held down
+    int keys[MAX_INPUT_KEYS];       // Keys pressed this frame in typing order
+    int keys_count;                 // Number of keys pressed this frame
+} Input;
+
 #define KEYBOARD_ROWS 3
 char keyboard_keys[KEYBOARD_ROWS][12] = {
     "QWERTYUIOP",
@@ -107,9 +168,51 @@ char keyboard_keys[KEYBOARD_ROWS][12] = {
     "ZXCVBNM"
 };
 static Game game = {0};
-static Font font = {0};
+static Input input = {0};
+static Wordle_Candidates candidates = {0};
+static Wordle_Outcomes outcomes = {0};
+static bool outcomes_ready = false;
+static Candidates_Panel candidates_panel = {0};
+static Stats stats = {0};
+static bool stats_visible = false;
+static bool profiler_visible = false;
+#if !defined(PLATFORM_WEB) && !defined(PLATFORM_HEADLESS)
+static const char *trace_path = TRACE_DEFAULT_PATH;    // Where Shift+D and --trace write the trace
+#endif
+static int stats_last_attempts = 0;         // Guesses of the last won game, its bar is highlighted
 
 static float cursor_timer = 0.0f;
+static float update_time = 0.0f;           // Frame time not yet simulated by update, less than UPDATE_STEP
+
+typedef struct Time_Scale {
+    float scale;                    // Animation speed multiplier, 0 skips animations entirely
+    char *label;                    // Label shown while the scale is active
+} Time_Scale;
+
+static Time_Scale time_scales[] = {
+    { 1.0f, NULL },
+    { 2.0f, "Speed: x2" },
+    { 0.0f, "Speed: instant" },
+    { 0.5f, "Speed: x0.5" },
+};
+static int time_scale_index = 0;
+static float time_scale = 1.0f;
+
+#define ARRAY_LEN(array) (sizeof(array)/sizeof(array[0]))
+
+
+void tick_timer(float *timer, float dt)
+{
+    if (*timer <= 0.0f) return;
+
+    if (time_scale <= 0.0f) {
+        *timer = 0.0f;
+    } else {
+        *timer -= dt * time_scale;
+        if (*timer < 0.0f) *timer = 0.0f;
+    }
+}
+
 
 bool find_keyboard_key(char chr, int *i, int *j)
 {
@@ -126,6 +229,40 @@ bool find_keyboard_key(char chr, int *i, int *j)
 }
 
 
+void reset_candidates_scroll(void)
+{
+    candidates_panel.scroll = 0.0f;
+    candidates_panel.scroll_target = 0.0f;
+}
+
+
+/* Scores the typed guess against every candidate. Called once when the
+ * guess gets complete rather than every frame. */
+void calculate_outcomes(const char *guess)
+{
+    wordle_outcomes(&candidates, guess, &outcomes);
+    outcomes_ready = true;
+    reset_candidates_scroll();
+}
+
+
+Color feedback_color(Wordle_Feedback feedback)
+{
+    switch (feedback) {
+        case WORDLE_FEEDBACK_CORRECT:   return GREEN_BOX_COLOR;
+        case WORDLE_FEEDBACK_MISPLACED: return YELLOW_BOX_COLOR;
+        case WORDLE_FEEDBACK_WRONG:     return WRONG_BOX_COLOR;
+    }
+    return WRONG_BOX_COLOR;
+}
+
+
+bool is_guess_prefix_valid(int len)
+{
+    return len == 0 || game.current_guess[len - 1].node >= 0;
+}
+
+
 void restart_game(void)
 {
     for (int i = 0; i < KEYBOARD_ROWS; ++i) {
@@ -134,33 +271,45 @@ void restart_game(void)
             game.keyboard[i][j].time = 0.0f;
         }
     }
-    game.word = words[rand() % WORDS];
+    wordle_new_game(&game.rules, rand() % WORDS);
 #ifdef DEBUG
 #   ifdef PLATFORM_WEB
-        print_word(game.word);
+        print_word((char *) wordle_answer(&game.rules));
 #   else
-        TraceLog(LOG_ERROR, "Word is %s", game.word);
+        TraceLog(LOG_ERROR, "Word is %s", wordle_answer(&game.rules));
 #   endif
 #endif
     game.win = false;
-    game.attempt = 0;
     game.current_guess_len = 0;
     for (int i = 0; i < WORD_LEN; ++i) {
         game.current_guess[i].chr = '\0';
     }
+    outcomes_ready = false;
     game.state = STATE_PLAY;
+    wordle_candidates_reset(&candidates);
+    reset_candidates_scroll();
 }
 
 
+/* Resets the whole session, not only the current game like restart_game */
 void init_game(void)
 {
+    game = (Game) {0};
+    candidates_panel = (Candidates_Panel) {0};
+    cursor_timer = 0.0f;
+    update_time = 0.0f;
+    time_scale_index = 0;
+    time_scale = time_scales[time_scale_index].scale;
+    stats_visible = false;
+    profiler_visible = false;
+    stats_last_attempts = 0;
     restart_game();
 }
 
 
 void draw_text(char *text, int x, int y, int font_size, Color color)
 {
-    DrawTextEx(font, text, CLITERAL(Vector2){x, y}, font_size, 1, color);
+    render_text(text, CLITERAL(Vector2){x, y}, font_size, 1, color);
 }
 
 
@@ -169,7 +318,7 @@ void draw_char(char chr, int char_box_size, int char_box_x, int char_box_y, int
     char text[2] = {0};
     text[0] = chr;
     text[1] = '\0';
-    Vector2 text_size = MeasureTextEx(font, text, font_size, 1);
+    Vector2 text_size = render_measure_text(text, font_size, 1);
     int x = (char_box_x + char_box_size/2) - text_size.x/2;
     int y = (char_box_y + char_box_size/2) - text_size.y/2;
     draw_text(text, x, y, font_size, LETTER_COLOR);
@@ -180,26 +329,33 @@ void draw_char(char chr, int char_box_size, int char_box_x, int char_box_y, int
 
 void draw_attempts(float t)
 {
-    int start_x = GetScreenWidth()/2 - FIELD_WIDTH/2;
-    int start_y = GetScreenHeight()/2 - (FIELD_HEIGHT+FIELD_MARGIN*2+KEYBOARD_HEIGHT)/2;
+    PROFILE_BEGIN(PROFILE_DRAW_ATTEMPTS);
+    int start_x = input.screen_width/2 - FIELD_WIDTH/2;
+    int start_y = input.screen_height/2 - (FIELD_HEIGHT+FIELD_MARGIN*2+KEYBOARD_HEIGHT)/2;
 
-    for (int i = 0; i < game.attempt; ++i) {
+    int attempts = game.rules.attempt;
+    for (int i = 0; i < attempts; ++i) {
         int row_y = start_y + (LETTER_BOX_SIZE + LETTER_BOX_GAP) * i;
+        char guess[WORD_LEN];
+        Wordle_Feedback feedback[WORD_LEN];
+        wordle_game_guess(&game.rules, i, guess);
+        wordle_game_feedback(&game.rules, i, feedback);
         for (int j = 0; j < WORD_LEN; ++j) {
             int x = start_x + (LETTER_BOX_SIZE + LETTER_BOX_GAP) * j;
             int y = row_y;
-            Color color = game.attempts[i].colors[j];
-            if (i == (game.attempt - 1)) {
+            Color color = feedback_color(feedback[j]);
+            if (i == (attempts - 1)) {
                 color = ColorLerp(LETTER_BOX_COLOR, color, t);
             }
-            if (game.state == STATE_USER_GUESS_CORRECT && (i == game.attempt - 1)) {
+            if (game.state == STATE_USER_GUESS_CORRECT && (i == attempts - 1)) {
                 float amount = 1.0f - (game.time/MAX_USER_GUESS_CORRECT);
                 y = Lerp(y, y+5, sinf(amount*6*PI+j));
             }
-            DrawRectangle(x, y, LETTER_BOX_SIZE, LETTER_BOX_SIZE, color);
-            draw_letter(game.attempts[i].word[j], x, y);
+            render_rectangle(x, y, LETTER_BOX_SIZE, LETTER_BOX_SIZE, color);
+            draw_letter(guess[j], x, y);
         }
     }
+    PROFILE_END(PROFILE_DRAW_ATTEMPTS);
     return;
 }
 
@@ -211,139 +367,150 @@ bool is_colors_equals(Color c1, Color c2)
 
 State make_attempt(void)
 {
-    State state = STATE_USER_GUESS_COLORING;
-
-    if (game.attempt == MAX_ATTEMPTS) return STATE_PLAY;
-
-#ifndef DEBUG
-    /* Check is word exists */
-    if (game.current_guess_len < WORD_LEN) return STATE_PLAY;
-
-    bool is_word_exists = false;
-    for (int i = 0; i < WORDS; ++i) {
-        bool is_same_words = true;
-        for (int j = 0; j < WORD_LEN; ++j) {
-            if (words[i][j] != game.current_guess[j].chr) {
-                is_same_words = false;
-            }
-        }
-        if (is_same_words) {
-            is_word_exists = true;
-            break;
-        }
-    }
-    if (!is_word_exists) return STATE_NON_EXISTENT_WORD;
-#endif
-
-    /* Check for win */
-    bool is_win = true;
+    char guess[WORD_LEN];
     for (int i = 0; i < WORD_LEN; ++i) {
-        if (game.current_guess[i].chr != game.word[i]) is_win = false;
-    }
-    if (is_win) {
-        state = STATE_USER_GUESS_CORRECT;
-        game.time = MAX_USER_GUESS_CORRECT;
+        guess[i] = game.current_guess[i].chr;
     }
 
-    /* Copy user guess to previous attempts */
-    for (int i = 0; i < WORD_LEN; ++i) {
-        game.attempts[game.attempt].word[i] = game.current_guess[i].chr;
-        game.current_guess[i].chr = '\0';
+    switch (wordle_submit_guess(&game.rules, guess)) {
+        case WORDLE_GUESS_ACCEPTED:     break;
+        case WORDLE_GUESS_UNKNOWN_WORD: return STATE_NON_EXISTENT_WORD;
+        case WORDLE_GUESS_INCOMPLETE:
+        case WORDLE_GUESS_GAME_OVER:    return STATE_PLAY;
     }
 
-    /* Calculate colors for letters in guess */
-
-    char word_buffer[WORD_LEN] = {0};
-    char guess_buffer[WORD_LEN] = {0};
     for (int i = 0; i < WORD_LEN; ++i) {
-        word_buffer[i] = game.word[i];
-        guess_buffer[i] = game.attempts[game.attempt].word[i];
+        game.current_guess[i].chr = '\0';
     }
 
+    /* Color keyboard keys by the feedback */
+    Wordle_Feedback feedback[WORD_LEN];
+    wordle_game_feedback(&game.rules, game.rules.attempt - 1, feedback);
     int row, col;
     for (int i = 0; i < WORD_LEN; ++i) {
-        bool key_found = find_keyboard_key(guess_buffer[i], &row, &col);
-        if (guess_buffer[i] == word_buffer[i]) {
+        if (!find_keyboard_key(guess[i], &row, &col)) continue;
+        if (feedback[i] == WORDLE_FEEDBACK_CORRECT) {
             game.keyboard[row][col].color = GREEN_BOX_COLOR;
-            game.attempts[game.attempt].colors[i] = GREEN_BOX_COLOR;
-            guess_buffer[i] = '\0';
-            word_buffer[i] = '\0';
-        } else {
-            game.attempts[game.attempt].colors[i] = WRONG_BOX_COLOR;
-            if (key_found && is_colors_equals(game.keyboard[row][col].color, DEFAULT_KEYBOARD_KEY_COLOR))
-                game.keyboard[row][col].color = WRONG_KEYBOARD_KEY_COLOR;
+        } else if (is_colors_equals(game.keyboard[row][col].color, DEFAULT_KEYBOARD_KEY_COLOR)) {
+            game.keyboard[row][col].color = WRONG_KEYBOARD_KEY_COLOR;
         }
     }
 
     for (int i = 0; i < WORD_LEN; ++i) {
-        if (word_buffer[i] == '\0') continue;
-        for (int j = 0; j < WORD_LEN; ++j) {
-            if (guess_buffer[j] == '\0') continue;
-            if (word_buffer[i] == guess_buffer[j]) {
-                find_keyboard_key(guess_buffer[j], &row, &col);
-                if (!is_colors_equals(game.keyboard[row][col].color, GREEN_BOX_COLOR))
-                    game.keyboard[row][col].color = YELLOW_BOX_COLOR;
-                game.attempts[game.attempt].colors[j] = YELLOW_BOX_COLOR;
-                guess_buffer[j] = '\0';
-                word_buffer[i] = '\0';
-                break;
-            }
-        }
+        if (feedback[i] != WORDLE_FEEDBACK_MISPLACED) continue;
+        find_keyboard_key(guess[i], &row, &col);
+        if (!is_colors_equals(game.keyboard[row][col].color, GREEN_BOX_COLOR))
+            game.keyboard[row][col].color = YELLOW_BOX_COLOR;
     }
 
-    /* The end of calculates */
+    wordle_candidates_filter(&candidates, guess, feedback);
+    reset_candidates_scroll();
 
     game.current_guess_len = 0;
-    game.attempt += 1;
-    if (game.attempt == MAX_ATTEMPTS && state != STATE_USER_GUESS_CORRECT) {
-        state = STATE_LOSE;
-        game.win = false;
+    outcomes_ready = false;
+
+    if (wordle_game_status(&game.rules) != WORDLE_STATUS_PLAYING) {
+        if (!stats_record_game(&stats, &game.rules, time(NULL))) TraceLog(LOG_WARNING, "Could not save the statistics");
+        stats_last_attempts = wordle_game_status(&game.rules) == WORDLE_STATUS_WON ? game.rules.attempt : 0;
     }
 
-    return state;
+    switch (wordle_game_status(&game.rules)) {
+        case WORDLE_STATUS_WON: {
+            game.time = MAX_USER_GUESS_CORRECT;
+            return STATE_USER_GUESS_CORRECT;
+        }
+        case WORDLE_STATUS_LOST: {
+            game.win = false;
+            return STATE_LOSE;
+        }
+        case WORDLE_STATUS_PLAYING: break;
+    }
+
+    return STATE_USER_GUESS_COLORING;
 }
 
 
-void process_input(void)
+void poll_input(void)
 {
-    if (IsKeyPressed(KEY_BACKSPACE)) {
-        if (game.current_guess_len > 0) --game.current_guess_len;
-        if (game.current_guess_len < WORD_LEN) {
-            game.current_guess[game.current_guess_len].chr = '\0';
-        }
-    } else if (IsKeyPressed(KEY_ENTER)) {
-        State state = make_attempt();
-        if (state == STATE_USER_GUESS_COLORING) {
-            game.time = USER_GUESS_COLORING_TIME;
-        } else if (state == STATE_NON_EXISTENT_WORD) {
-            game.time = MAX_NON_EXISTENT_WORD_TIMER;
-        }
-        game.state = state;
-        return;
+    input.dt = GetFrameTime();
+    input.screen_width = GetScreenWidth();
+    input.screen_height = GetScreenHeight();
+    input.mouse = GetMousePosition();
+    input.wheel = GetMouseWheelMove();
+    input.mouse_pressed = IsMouseButtonPressed(MOUSE_BUTTON_LEFT);
+    input.keys_count = 0;
+    input.shift = IsKeyDown(KEY_LEFT_SHIFT);
+    for (int key = GetKeyPressed(); key != 0; key = GetKeyPressed()) {
+        if (input.keys_count < MAX_INPUT_KEYS) input.keys[input.keys_count++] = key;
     }
+}
 
+
+void add_guess_letter(char chr)
+{
     if (game.current_guess_len >= WORD_LEN) return;
 
-    for (int key = KEY_A; key <= KEY_Z; ++key) {
-        if (!IsKeyDown(KEY_LEFT_SHIFT) && IsKeyPressed(key)) {
-            game.current_guess[game.current_guess_len].chr = key;
-            game.current_guess[game.current_guess_len].time = MAX_KEY_TIMER;
-            ++game.current_guess_len;
+    int node = game.current_guess_len > 0 ? game.current_guess[game.current_guess_len - 1].node : WORDLE_TRIE_ROOT;
+    game.current_guess[game.current_guess_len].chr = chr;
+    game.current_guess[game.current_guess_len].time = MAX_KEY_TIMER;
+    game.current_guess[game.current_guess_len].node = wordle_trie_step(node, chr);
+    ++game.current_guess_len;
+
+    int row, col;
+    if (find_keyboard_key(chr, &row, &col)) game.keyboard[row][col].time = MAX_KEYBOARD_TIMER;
+
+    if (game.current_guess_len == WORD_LEN && !candidates_panel.hidden) {
+        char guess[WORD_LEN];
+        for (int i = 0; i < WORD_LEN; ++i) guess[i] = game.current_guess[i].chr;
+        calculate_outcomes(guess);
+    }
+}
+
+
+void remove_guess_letter(void)
+{
+    outcomes_ready = false;
+    if (game.current_guess_len > 0) --game.current_guess_len;
+    if (game.current_guess_len < WORD_LEN) {
+        game.current_guess[game.current_guess_len].chr = '\0';
+    }
+}
+
+
+void submit_guess(void)
+{
+    State state;
+    TRACE_SCOPE("make_attempt") PROFILE_SCOPE(PROFILE_MAKE_ATTEMPT) state = make_attempt();
+    if (state == STATE_USER_GUESS_COLORING) {
+        game.time = USER_GUESS_COLORING_TIME;
+    } else if (state == STATE_NON_EXISTENT_WORD) {
+        game.time = MAX_NON_EXISTENT_WORD_TIMER;
+    }
+    game.state = state;
+}
+
+
+void process_input(void)
+{
+    for (int i = 0; i < input.keys_count; ++i) {
+        int key = input.keys[i];
+        if (key == KEY_BACKSPACE) {
+            remove_guess_letter();
+        } else if (key == KEY_ENTER) {
+            submit_guess();
+            return;
+        } else if (key >= KEY_A && key <= KEY_Z && !input.shift) {
+            add_guess_letter(key);
         }
     }
 }
 
 void draw_cursor(int letter_box_x, int letter_box_y, float time)
 {
-    cursor_timer += GetFrameTime();
     if (cursor_timer >= 0.25f) {
         int x = (letter_box_x + LETTER_BOX_SIZE/2) - CURSOR_WIDTH/2;
         int y = (letter_box_y + LETTER_BOX_SIZE/2) - CURSOR_HEIGHT/2;
-        DrawRectangle(x, y, CURSOR_WIDTH, CURSOR_HEIGHT, ColorAlpha(CURSOR_COLOR, time));
-    }
-
-    if (cursor_timer >= MAX_CURSOR_TIMER) {
-        cursor_timer = 0.0f;
+        render_rectangle(x, y, CURSOR_WIDTH, CURSOR_HEIGHT, ColorAlpha(CURSOR_COLOR, time));
     }
 }
 
@@ -351,18 +518,17 @@ void draw_cursor(int letter_box_x, int letter_box_y, float time)
 void draw_user_guess(float t)
 {
     if (game.win) return;
-    if (game.attempt >= MAX_ATTEMPTS) return;
+    if (game.rules.attempt >= MAX_ATTEMPTS) return;
+    PROFILE_BEGIN(PROFILE_DRAW_USER_GUESS);
 
-    int start_x = GetScreenWidth()/2 - FIELD_WIDTH/2;
-    int start_y = GetScreenHeight()/2 - (FIELD_HEIGHT+FIELD_MARGIN*2+KEYBOARD_HEIGHT)/2;
+    int start_x = input.screen_width/2 - FIELD_WIDTH/2;
+    int start_y = input.screen_height/2 - (FIELD_HEIGHT+FIELD_MARGIN*2+KEYBOARD_HEIGHT)/2;
 
-    int min_y = start_y + (LETTER_BOX_SIZE + LETTER_BOX_GAP) * (game.attempt - 1);
-    int max_y = start_y + (LETTER_BOX_SIZE + LETTER_BOX_GAP) * game.attempt;
+    int min_y = start_y + (LETTER_BOX_SIZE + LETTER_BOX_GAP) * (game.rules.attempt - 1);
+    int max_y = start_y + (LETTER_BOX_SIZE + LETTER_BOX_GAP) * game.rules.attempt;
 
     int base_y = Lerp(min_y, max_y, t);
     for (int c = 0; c < WORD_LEN; ++c) {
-        if (game.current_guess[c].time > 0.0f) game.current_guess[c].time -= GetFrameTime();
-
         float amount = 1.0f - game.current_guess[c].time/MAX_KEY_TIMER;
         int offset = Lerp(0, 10, sinf(PI*amount));
         int size = LETTER_BOX_SIZE + offset;
@@ -374,14 +540,17 @@ void draw_user_guess(float t)
             float t = 1.0f - (game.time/MAX_NON_EXISTENT_WORD_TIMER);
             int offset = Lerp(0, 10, sinf(4*PI*t));
             y += offset;
-            DrawRectangle(x, y, size, size, ColorLerp(LETTER_BOX_COLOR, RED, sinf(PI*t)));
+            render_rectangle(x, y, size, size, ColorLerp(LETTER_BOX_COLOR, RED, sinf(PI*t)));
+        } else if (c < game.current_guess_len && !is_guess_prefix_valid(c + 1)) {
+            render_rectangle(x, y, size, size, ColorAlpha(INVALID_BOX_COLOR, t));
         } else {
-            DrawRectangle(x, y, size, size, ColorAlpha(LETTER_BOX_COLOR, t));
+            render_rectangle(x, y, size, size, ColorAlpha(LETTER_BOX_COLOR, t));
         }
         if (c < game.current_guess_len) draw_char(game.current_guess[c].chr, size, x, y, LETTER_FONT_SIZE);
         if (c == game.current_guess_len) draw_cursor(x, y, t);
     }
 
+    PROFILE_END(PROFILE_DRAW_USER_GUESS);
     return;
 }
 
@@ -397,83 +566,55 @@ size_t strlen(const char *string)
     return size;
 }
 
-void draw_enter(bool active)
+int keyboard_y(void)
+{
+    return input.screen_height/2 - (FIELD_HEIGHT + FIELD_MARGIN*2 + KEYBOARD_HEIGHT)/2 + FIELD_HEIGHT + FIELD_MARGIN*2;
+}
+
+
+Rectangle enter_key_rect(void)
 {
-    int start_y = GetScreenHeight()/2 - (FIELD_HEIGHT + FIELD_MARGIN*2 + KEYBOARD_HEIGHT)/2 + FIELD_HEIGHT + FIELD_MARGIN*2;
     int len = strlen(keyboard_keys[0]);
     int row_width = len * KEYBOARD_KEY_SIZE + ((len - 1) * KEYBOARD_GAP);
-    int start_x = GetScreenWidth()/2 - row_width/2;
+    int start_x = input.screen_width/2 - row_width/2;
     len = strlen(keyboard_keys[2]);
     row_width = len * KEYBOARD_KEY_SIZE + ((len - 1) * KEYBOARD_GAP);
-    int end_x = GetScreenWidth()/2 - row_width/2 - KEYBOARD_GAP;
-    int enter_width = end_x - start_x;
-    int y = start_y + 2 * KEYBOARD_KEY_SIZE + 2 * KEYBOARD_GAP;
-
-    Rectangle key_rect = { start_x, y, enter_width, KEYBOARD_KEY_SIZE };
-
-    bool is_hovered = CheckCollisionPointRec(
-        GetMousePosition(),
-        key_rect
-    );
-
-    Color color = DEFAULT_KEYBOARD_KEY_COLOR;
-    Color outline_color = is_hovered && active ? WHITE : color;
-
-    DrawRectangleRounded(key_rect, 0.2f, 0, color);
-    DrawRectangleRoundedLinesEx(key_rect, 0.2f, 0, 2, outline_color);
-
-    char text[] = "Enter";
-    Vector2 text_size = MeasureTextEx(font, text, KEYBOARD_FONT_SIZE, 1);
-    int tx = start_x + (enter_width/2 - text_size.x/2);
-    int ty = y + (KEYBOARD_KEY_SIZE/2 - text_size.y/2);
-    draw_text(text, tx, ty, KEYBOARD_FONT_SIZE, LETTER_COLOR);
-
-    if (active && is_hovered && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-        State state = make_attempt();
-        if (state == STATE_USER_GUESS_COLORING) {
-            game.time = USER_GUESS_COLORING_TIME;
-        }
-        game.state = state;
-    }
+    int end_x = input.screen_width/2 - row_width/2 - KEYBOARD_GAP;
+    int y = keyboard_y() + 2 * KEYBOARD_KEY_SIZE + 2 * KEYBOARD_GAP;
+    return (Rectangle) { start_x, y, end_x - start_x, KEYBOARD_KEY_SIZE };
 }
 
-void draw_backspace(bool active)
+
+Rectangle backspace_key_rect(void)
 {
-    int start_y = GetScreenHeight()/2 - (FIELD_HEIGHT + FIELD_MARGIN*2 + KEYBOARD_HEIGHT)/2 + FIELD_HEIGHT + FIELD_MARGIN*2;
     int len = strlen(keyboard_keys[0]);
     int row_width = len * KEYBOARD_KEY_SIZE + ((len - 1) * KEYBOARD_GAP);
-    int end_x = GetScreenWidth()/2 + row_width/2;
+    int end_x = input.screen_width/2 + row_width/2;
     len = strlen(keyboard_keys[2]);
     row_width = len * KEYBOARD_KEY_SIZE + ((len - 1) * KEYBOARD_GAP);
-    int start_x = GetScreenWidth()/2 + row_width/2 + KEYBOARD_GAP;
-    int enter_width = end_x - start_x;
-    int y = start_y + 2 * KEYBOARD_KEY_SIZE + 2 * KEYBOARD_GAP;
+    int start_x = input.screen_width/2 + row_width/2 + KEYBOARD_GAP;
+    int y = keyboard_y() + 2 * KEYBOARD_KEY_SIZE + 2 * KEYBOARD_GAP;
+    return (Rectangle) { start_x, y, end_x - start_x, KEYBOARD_KEY_SIZE };
+}
 
-    Rectangle key_rect = { start_x, y, enter_width, KEYBOARD_KEY_SIZE };
 
+void draw_wide_key(Rectangle key_rect, char *text, bool active)
+{
     bool is_hovered = CheckCollisionPointRec(
-        GetMousePosition(),
+        input.mouse,
         key_rect
     );
 
     Color color = DEFAULT_KEYBOARD_KEY_COLOR;
     Color outline_color = is_hovered && active ? WHITE : color;
 
-    DrawRectangleRounded(key_rect, 0.2f, 0, color);
-    DrawRectangleRoundedLinesEx(key_rect, 0.2f, 0, 2, outline_color);
+    render_rectangle_rounded(key_rect, 0.2f, color);
+    render_rectangle_rounded_lines(key_rect, 0.2f, 2, outline_color);
 
-    char text[] = "<";
-    Vector2 text_size = MeasureTextEx(font, text, KEYBOARD_FONT_SIZE, 1);
-    int tx = start_x + (enter_width/2 - text_size.x/2);
-    int ty = y + (KEYBOARD_KEY_SIZE/2 - text_size.y/2);
+    Vector2 text_size = render_measure_text(text, KEYBOARD_FONT_SIZE, 1);
+    int tx = key_rect.x + (key_rect.width/2 - text_size.x/2);
+    int ty = key_rect.y + (KEYBOARD_KEY_SIZE/2 - text_size.y/2);
     draw_text(text, tx, ty, KEYBOARD_FONT_SIZE, LETTER_COLOR);
-
-    if (active && is_hovered && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-        if (game.current_guess_len > 0) --game.current_guess_len;
-        if (game.current_guess_len < WORD_LEN) {
-            game.current_guess[game.current_guess_len].chr = '\0';
-        }
-    }
 }
 
 int calc_size_with_gaps(int size_px, int gap_px, int count)
@@ -481,56 +622,281 @@ int calc_size_with_gaps(int size_px, int gap_px, int count)
     return count * size_px + (count - 1) * gap_px;
 }
 
+
+Rectangle keyboard_key_rect(int row, int col)
+{
+    int keys_in_row = strlen(keyboard_keys[row]);
+    int row_width = calc_size_with_gaps(KEYBOARD_KEY_SIZE, KEYBOARD_GAP, keys_in_row);
+    int row_x = input.screen_width/2 - row_width/2;
+    int x = row_x + (col*KEYBOARD_KEY_SIZE + col*KEYBOARD_GAP);
+    int y = keyboard_y() + (row*KEYBOARD_KEY_SIZE + row*KEYBOARD_GAP);
+    return (Rectangle) { x, y, KEYBOARD_KEY_SIZE, KEYBOARD_KEY_SIZE };
+}
+
+/* Keys without feedback yet are tinted by how many candidates contain their letter */
+Color keyboard_key_color(int row, int col)
+{
+    Color color = game.keyboard[row][col].color;
+    if (candidates_panel.hidden || candidates.count == 0) return color;
+    if (!is_colors_equals(color, DEFAULT_KEYBOARD_KEY_COLOR)) return color;
+
+    int letter = keyboard_keys[row][col] - 'A';
+    float frequency = (float)candidates.letter_counts[letter] / candidates.count;
+    return ColorLerp(color, HEATMAP_KEY_COLOR, frequency);
+}
+
+
 void draw_keyboard(bool active)
 {
-    int keyboard_y = GetScreenHeight()/2 - (FIELD_HEIGHT + FIELD_MARGIN*2 + KEYBOARD_HEIGHT)/2 + FIELD_HEIGHT + FIELD_MARGIN*2;
+    PROFILE_BEGIN(PROFILE_DRAW_KEYBOARD);
     for (int i = 0; i < 3; ++i) {
         for (int j = 0; keyboard_keys[i][j]; ++j) {
             Key *key = &game.keyboard[i][j];
 
-            bool is_key_was_pressed = key->time >= 0.0f;
             float t = sinf(((key->time/MAX_KEYBOARD_TIMER)) * PI);
-            if (is_key_was_pressed) key->time -= GetFrameTime();
-            int margin = is_key_was_pressed ? Lerp(0, 3, t) : 0;
+            int margin = Lerp(0, 3, t);
             int size = KEYBOARD_KEY_SIZE + margin*2;
 
-            int keys_in_row = strlen(keyboard_keys[i]);
-            int row_width = calc_size_with_gaps(KEYBOARD_KEY_SIZE, KEYBOARD_GAP, keys_in_row);
-            int row_x = GetScreenWidth()/2 - row_width/2;
-            int x = row_x + (j*KEYBOARD_KEY_SIZE + j*KEYBOARD_GAP) - margin;
-            int y = keyboard_y + (i*KEYBOARD_KEY_SIZE + i*KEYBOARD_GAP) - margin;
-
-            Rectangle key_rect = { x, y, size, size };
+            Rectangle key_rect = keyboard_key_rect(i, j);
+            key_rect.x -= margin;
+            key_rect.y -= margin;
+            key_rect.width = size;
+            key_rect.height = size;
 
             bool is_hovered = CheckCollisionPointRec(
-                GetMousePosition(),
+                input.mouse,
                 key_rect
             );
 
-            Color color = ColorLerp(game.keyboard[i][j].color, PRESSED_KEYBOARD_KEY_COLOR, t);
-            DrawRectangleRounded(key_rect, 0.2f, 0, color);
+            Color color = ColorLerp(keyboard_key_color(i, j), PRESSED_KEYBOARD_KEY_COLOR, t);
+            render_rectangle_rounded(key_rect, 0.2f, color);
 
             Color outline_color = is_hovered && active ? WHITE : color;
-            DrawRectangleRoundedLinesEx(key_rect, 0.2f, 0, 2, outline_color);
+            render_rectangle_rounded_lines(key_rect, 0.2f, 2, outline_color);
 
-            draw_char(keyboard_keys[i][j], size, x, y, KEYBOARD_FONT_SIZE);
+            draw_char(keyboard_keys[i][j], size, key_rect.x, key_rect.y, KEYBOARD_FONT_SIZE);
+        }
+    }
 
-            if (active && (!IsKeyDown(KEY_LEFT_SHIFT) && IsKeyPressed(keyboard_keys[i][j])) && game.current_guess_len < WORD_LEN) {
-                game.keyboard[i][j].time = MAX_KEYBOARD_TIMER;
-            }
+    draw_wide_key(enter_key_rect(), "Enter", active);
+    draw_wide_key(backspace_key_rect(), "<", active);
+    PROFILE_END(PROFILE_DRAW_KEYBOARD);
+}
 
-            if (active && is_hovered && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-                if (game.current_guess_len >= WORD_LEN) continue;
-                game.current_guess[game.current_guess_len].chr = keyboard_keys[i][j];
-                game.current_guess[game.current_guess_len].time = MAX_KEY_TIMER;
-                ++game.current_guess_len;
-                game.keyboard[i][j].time = MAX_KEYBOARD_TIMER;
-            }
+
+/* Clicks on the on-screen keyboard, hit against the keys at rest */
+void process_mouse(void)
+{
+    if (!input.mouse_pressed) return;
+
+    for (int i = 0; i < KEYBOARD_ROWS; ++i) {
+        for (int j = 0; keyboard_keys[i][j]; ++j) {
+            if (CheckCollisionPointRec(input.mouse, keyboard_key_rect(i, j))) add_guess_letter(keyboard_keys[i][j]);
+        }
+    }
+    if (CheckCollisionPointRec(input.mouse, enter_key_rect())) submit_guess();
+    if (CheckCollisionPointRec(input.mouse, backspace_key_rect())) remove_guess_letter();
+}
+
+
+/* Writes a non-negative number into buffer, which must fit 12 chars */
+char *int_to_text(int value, char *buffer)
+{
+    char digits[12] = {0};
+    int len = 0;
+    do {
+        digits[len++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    for (int i = 0; i < len; ++i) buffer[i] = digits[len - 1 - i];
+    buffer[len] = '\0';
+    return buffer;
+}
+
+
+/* Writes a non-negative number with one decimal digit into buffer, which must fit 16 chars */
+char *float_to_text(float value, char *buffer)
+{
+    int tenths = value * 10.0f + 0.5f;
+    int_to_text(tenths / 10, buffer);
+    int len = 0;
+    while (buffer[len] != '\0') ++len;
+    buffer[len] = '.';
+    buffer[len + 1] = '0' + tenths % 10;
+    buffer[len + 2] = '\0';
+    return buffer;
+}
+
+
+void draw_outcome_row(Wordle_Outcome outcome, int x, int y, float alpha)
+{
+    int size = CANDIDATES_ROW_HEIGHT - CANDIDATES_PADDING;
+    int pattern = outcome.pattern;
+    for (int i = 0; i < WORD_LEN; ++i) {
+        Color color = feedback_color(pattern % 3);
+        render_rectangle(x + i * (size + 2), y + CANDIDATES_PADDING/2, size, size, ColorAlpha(color, alpha));
+        pattern /= 3;
+    }
+
+    char count[12];
+    int count_x = x + WORD_LEN * (size + 2) + CANDIDATES_PADDING;
+    draw_text(int_to_text(outcome.count, count), count_x, y, CANDIDATES_FONT_SIZE, ColorAlpha(LETTER_COLOR, alpha));
+}
+
+
+/* Returns false when the panel is hidden or does not fit next to the field */
+bool candidates_panel_rect(Rectangle *rect)
+{
+    if (candidates_panel.hidden) return false;
+
+    int field_x = input.screen_width/2 - FIELD_WIDTH/2;
+    int x = field_x + FIELD_WIDTH + FIELD_MARGIN;
+    int y = input.screen_height/2 - (FIELD_HEIGHT+FIELD_MARGIN*2+KEYBOARD_HEIGHT)/2;
+    if (x + CANDIDATES_WIDTH > input.screen_width) return false;
+
+    *rect = (Rectangle) { x, y, CANDIDATES_WIDTH, FIELD_HEIGHT };
+    return true;
+}
+
+
+int candidates_rows_count(void)
+{
+    return outcomes_ready ? outcomes.count : candidates.count;
+}
+
+
+float candidates_max_scroll(void)
+{
+    int content_height = candidates_rows_count() * CANDIDATES_ROW_HEIGHT;
+    return content_height > CANDIDATES_LIST_HEIGHT ? content_height - CANDIDATES_LIST_HEIGHT : 0.0f;
+}
+
+
+void scroll_candidates(void)
+{
+    Rectangle panel_rect;
+    if (!candidates_panel_rect(&panel_rect)) return;
+
+    if (CheckCollisionPointRec(input.mouse, panel_rect)) {
+        candidates_panel.scroll_target -= input.wheel * CANDIDATES_WHEEL_ROWS * CANDIDATES_ROW_HEIGHT;
+    }
+}
+
+
+void update_candidates_scroll(float dt)
+{
+    candidates_panel.scroll_target = Clamp(candidates_panel.scroll_target, 0.0f, candidates_max_scroll());
+    candidates_panel.scroll = Lerp(candidates_panel.scroll, candidates_panel.scroll_target, Clamp(dt * CANDIDATES_SCROLL_SPEED, 0.0f, 1.0f));
+}
+
+
+/* Only the rows that are inside of the panel are drawn, so the cost does
+ * not depend on how many candidates are left. While a complete guess is
+ * typed the panel lists how many candidates every feedback would leave. */
+void draw_candidates(void)
+{
+    Rectangle panel_rect;
+    if (!candidates_panel_rect(&panel_rect)) return;
+    int x = panel_rect.x;
+    int y = panel_rect.y;
+
+    render_rectangle(x, y, CANDIDATES_WIDTH, FIELD_HEIGHT, CANDIDATES_PANEL_COLOR);
+
+    char header[16];
+    int rows_count = candidates_rows_count();
+    if (outcomes_ready) {
+        header[0] = '~';
+        float_to_text(outcomes.expected, header + 1);
+    } else {
+        int_to_text(candidates.count, header);
+    }
+    draw_text(header, x + CANDIDATES_PADDING, y + CANDIDATES_PADDING/2, CANDIDATES_FONT_SIZE, LETTER_COLOR);
+
+    int list_y = y + CANDIDATES_ROW_HEIGHT + CANDIDATES_PADDING;
+    int list_height = CANDIDATES_LIST_HEIGHT;
+    int content_height = rows_count * CANDIDATES_ROW_HEIGHT;
+    float max_scroll = candidates_max_scroll();
+
+    int first = candidates_panel.scroll / CANDIDATES_ROW_HEIGHT;
+    int visible = list_height / CANDIDATES_ROW_HEIGHT + 2;
+    int last = first + visible < rows_count ? first + visible : rows_count;
+    for (int i = first; i < last; ++i) {
+        float row_y = list_y + i * CANDIDATES_ROW_HEIGHT - candidates_panel.scroll;
+
+        /* Rows crossing the edges of the list fade out instead of being clipped */
+        float alpha = 1.0f;
+        if (row_y < list_y) alpha = 1.0f - (list_y - row_y) / CANDIDATES_ROW_HEIGHT;
+        if (row_y + CANDIDATES_ROW_HEIGHT > list_y + list_height) alpha = (list_y + list_height - row_y) / CANDIDATES_ROW_HEIGHT;
+        if (alpha <= 0.0f) continue;
+
+        if (outcomes_ready) {
+            draw_outcome_row(outcomes.items[i], x + CANDIDATES_PADDING, row_y, alpha);
+        } else {
+            draw_text((char *) wordle_word(candidates.items[i]), x + CANDIDATES_PADDING, row_y, CANDIDATES_FONT_SIZE, ColorAlpha(LETTER_COLOR, alpha));
         }
     }
 
-    draw_enter(active);
-    draw_backspace(active);
+    if (max_scroll > 0.0f) {
+        int bar_height = (float)list_height * list_height / content_height;
+        if (bar_height < CANDIDATES_PADDING) bar_height = CANDIDATES_PADDING;
+        int bar_y = list_y + (list_height - bar_height) * (candidates_panel.scroll / max_scroll);
+        render_rectangle(x + CANDIDATES_WIDTH - CANDIDATES_PADDING/2, bar_y, CANDIDATES_PADDING/4, bar_height, CANDIDATES_SCROLLBAR_COLOR);
+    }
+}
+
+
+void draw_stat(unsigned int value, char *label, int x, int y, int width)
+{
+    char text[12];
+    int_to_text(value, text);
+    Vector2 value_size = render_measure_text(text, STATS_VALUE_FONT_SIZE, 1);
+    draw_text(text, x + width/2 - value_size.x/2, y, STATS_VALUE_FONT_SIZE, LETTER_COLOR);
+    Vector2 label_size = render_measure_text(label, STATS_LABEL_FONT_SIZE, 1);
+    draw_text(label, x + width/2 - label_size.x/2, y + value_size.y, STATS_LABEL_FONT_SIZE, LETTER_COLOR);
+}
+
+
+/* Totals and the guess distribution, drawn over the field from the loaded
+ * snapshot plus the games finished since */
+void draw_stats(void)
+{
+    if (!stats_visible) return;
+
+    int bars_height = MAX_ATTEMPTS * (STATS_BAR_HEIGHT + STATS_BAR_GAP);
+    int height = STATS_PADDING*4 + STATS_VALUE_FONT_SIZE + STATS_LABEL_FONT_SIZE*2 + bars_height;
+    int x = input.screen_width/2 - STATS_WIDTH/2;
+    int y = input.screen_height/2 - (FIELD_HEIGHT+FIELD_MARGIN*2+KEYBOARD_HEIGHT)/2;
+    render_rectangle(x, y, STATS_WIDTH, height, STATS_PANEL_COLOR);
+
+    int column_width = (STATS_WIDTH - STATS_PADDING*2) / 4;
+    int win_percent = stats.played > 0 ? (stats.won * 100 + stats.played/2) / stats.played : 0;
+    int row_y = y + STATS_PADDING;
+    draw_stat(stats.played, "Played", x + STATS_PADDING, row_y, column_width);
+    draw_stat(win_percent, "Win %", x + STATS_PADDING + column_width, row_y, column_width);
+    draw_stat(stats.current_streak, "Streak", x + STATS_PADDING + column_width*2, row_y, column_width);
+    draw_stat(stats.max_streak, "Max Streak", x + STATS_PADDING + column_width*3, row_y, column_width);
+
+    unsigned int max_count = 1;
+    for (int i = 0; i < MAX_ATTEMPTS; ++i) {
+        if (stats.distribution[i] > max_count) max_count = stats.distribution[i];
+    }
+
+    int bars_x = x + STATS_PADDING + STATS_LABEL_FONT_SIZE;
+    int bars_width = STATS_WIDTH - STATS_PADDING*2 - STATS_LABEL_FONT_SIZE;
+    int bars_y = row_y + STATS_VALUE_FONT_SIZE + STATS_LABEL_FONT_SIZE*2 + STATS_PADDING;
+    for (int i = 0; i < MAX_ATTEMPTS; ++i) {
+        char text[12];
+        int bar_y = bars_y + i * (STATS_BAR_HEIGHT + STATS_BAR_GAP);
+        draw_text(int_to_text(i + 1, text), x + STATS_PADDING, bar_y, STATS_LABEL_FONT_SIZE, LETTER_COLOR);
+
+        int_to_text(stats.distribution[i], text);
+        Vector2 count_size = render_measure_text(text, STATS_LABEL_FONT_SIZE, 1);
+        int min_width = count_size.x + STATS_BAR_GAP*2;
+        int bar_width = min_width + (float)(bars_width - min_width) * stats.distribution[i] / max_count;
+        Color color = i + 1 == stats_last_attempts ? STATS_LAST_BAR_COLOR : STATS_BAR_COLOR;
+        render_rectangle(bars_x, bar_y, bar_width, STATS_BAR_HEIGHT, color);
+        draw_text(text, bars_x + bar_width - STATS_BAR_GAP - count_size.x, bar_y, STATS_LABEL_FONT_SIZE, LETTER_COLOR);
+    }
 }
 
 
@@ -539,7 +905,6 @@ void draw_game_play(void)
     draw_user_guess(1.0f);
     draw_attempts(1.0f);
     draw_keyboard(true);
-    process_input();
 }
 
 void draw_game_non_existent_word(void)
@@ -580,18 +945,19 @@ void draw_game_lose(void)
 {
     draw_attempts(1.0f);
     draw_keyboard(false);
-    Vector2 text_size = MeasureTextEx(font, game.word, LETTER_FONT_SIZE, 1);
+    const char *word = wordle_answer(&game.rules);
+    Vector2 text_size = render_measure_text(word, LETTER_FONT_SIZE, 1);
     int width = text_size.x + 100;
     int height = text_size.y + 10;
-    int x = GetScreenWidth()/2 - width/2;
-    int y = GetScreenHeight()/2 - (FIELD_HEIGHT+FIELD_MARGIN*2+KEYBOARD_HEIGHT)/2;
-    DrawRectangle(x, y, width, height, LOSE_BOX_COLOR);
-    DrawRectangleLines(x, y, width, height, ColorBrightness(LOSE_BOX_COLOR, -0.5f));
+    int x = input.screen_width/2 - width/2;
+    int y = input.screen_height/2 - (FIELD_HEIGHT+FIELD_MARGIN*2+KEYBOARD_HEIGHT)/2;
+    render_rectangle(x, y, width, height, LOSE_BOX_COLOR);
+    render_rectangle_lines(x, y, width, height, ColorBrightness(LOSE_BOX_COLOR, -0.5f));
     Vector2 text_pos = {
         .x = (x + width/2 - text_size.x/2),
         .y = (y + height/2 - text_size.y/2)
     };
-    DrawTextEx(font, game.word, text_pos, LETTER_FONT_SIZE, 1.0f, LETTER_COLOR);
+    render_text(word, text_pos, LETTER_FONT_SIZE, 1.0f, LETTER_COLOR);
 }
 
 void draw_game_restart(float t)
@@ -599,61 +965,103 @@ void draw_game_restart(float t)
     draw_attempts(1.0f);
     draw_user_guess(1.0f);
     draw_keyboard(false);
-    DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), ColorAlpha(BLACK, t));
+    render_rectangle(0, 0, input.screen_width, input.screen_height, ColorAlpha(BLACK, t));
 }
 
 
-void draw_game_state(void)
+bool advance_game_state(void)
+{
+    if (game.time > 0.0f) return false;
+
+    switch (game.state) {
+        case STATE_RESTART_FADEIN: {
+            restart_game();
+            game.state = STATE_RESTART_FADEOUT;
+            game.time = MAX_RESTART_TIMER;
+        } break;
+        case STATE_RESTART_FADEOUT: {
+            game.state = STATE_PLAY;
+            game.time = 0.0f;
+        } break;
+        case STATE_USER_GUESS_CORRECT: {
+            game.state = STATE_WIN;
+            game.win = true;
+            game.time = 0.0f;
+        } break;
+        case STATE_NON_EXISTENT_WORD: {
+            game.state = STATE_PLAY;
+            game.time = 0.0f;
+        } break;
+        case STATE_USER_GUESS_COLORING: {
+            game.state = STATE_USER_GUESS_APPEAR;
+            game.time = USER_GUESS_APPER_TIME;
+        } break;
+        case STATE_USER_GUESS_APPEAR: {
+            game.state = STATE_PLAY;
+        } break;
+        case STATE_PLAY:
+        case STATE_WIN:
+        case STATE_LOSE:
+            return false;
+    }
+
+    return true;
+}
+
+
+/* Advances the game by dt seconds of animation time */
+void update(float dt)
+{
+    tick_timer(&game.time, dt);
+    advance_game_state();
+
+    for (int c = 0; c < WORD_LEN; ++c) {
+        tick_timer(&game.current_guess[c].time, dt);
+    }
+    for (int i = 0; i < KEYBOARD_ROWS; ++i) {
+        for (int j = 0; keyboard_keys[i][j]; ++j) {
+            tick_timer(&game.keyboard[i][j].time, dt);
+        }
+    }
+
+    cursor_timer += dt;
+    if (cursor_timer >= MAX_CURSOR_TIMER) cursor_timer -= MAX_CURSOR_TIMER;
+
+    update_candidates_scroll(dt);
+}
+
+
+void skip_animations(void)
 {
+    do {
+        game.time = 0.0f;
+    } while (advance_game_state());
+}
 
-    if (game.time > 0.0f) game.time -= GetFrameTime();
 
+void draw_game_state(void)
+{
     switch (game.state) {
         case STATE_PLAY: {
             draw_game_play();
         } break;
         case STATE_RESTART_FADEIN: {
-            float t = 1.0f - game.time / MAX_RESTART_TIMER;
-            draw_game_restart(t);
-            if (game.time <= 0.0f) {
-                restart_game();
-                game.state = STATE_RESTART_FADEOUT;
-                game.time = MAX_RESTART_TIMER;
-            }
+            draw_game_restart(1.0f - game.time / MAX_RESTART_TIMER);
         } break;
         case STATE_RESTART_FADEOUT: {
-            float t = game.time / MAX_RESTART_TIMER;
-            draw_game_restart(t);
-            if (game.time <= 0.0f) {
-                game.state = STATE_PLAY;
-                game.time = 0.0f;
-            }
+            draw_game_restart(game.time / MAX_RESTART_TIMER);
         } break;
         case STATE_USER_GUESS_CORRECT: {
             draw_user_guess_correct();
-            if (game.time <= 0.0f) {
-                game.state = STATE_WIN;
-                game.win = true;
-                game.time = 0.0f;
-            }
         } break;
         case STATE_NON_EXISTENT_WORD: {
             draw_game_non_existent_word();
-            if (game.time <= 0.0f) {
-                game.state = STATE_PLAY;
-                game.time = 0.0f;
-            }
         } break;
         case STATE_USER_GUESS_COLORING: {
             draw_game_user_guess_coloring();
-            if (game.time <= 0.0f) {
-                game.state = STATE_USER_GUESS_APPEAR;
-                game.time = USER_GUESS_APPER_TIME;
-            }
         } break;
         case STATE_USER_GUESS_APPEAR: {
             draw_game_user_guess_appear();
-            if (game.time <= 0.0f) game.state = STATE_PLAY;
         } break;
         case STATE_WIN: {
             draw_game_win();
@@ -667,34 +1075,388 @@ void draw_game_state(void)
 }
 
 
-void game_frame(void)
+void draw_time_scale(void)
+{
+    char *label = time_scales[time_scale_index].label;
+    if (label == NULL) return;
+
+    draw_text(label, FIELD_MARGIN, FIELD_MARGIN, KEYBOARD_FONT_SIZE/2, LETTER_COLOR);
+}
+
+
+/* Average and worst time of every section over the last frames, and a
+ * histogram of the frame times below them */
+void draw_profiler(void)
+{
+#ifdef PROFILER_ENABLED
+    if (!profiler_visible) return;
+
+    int rows = PROFILE_SECTIONS + 1;
+    int height = PROFILER_PADDING*3 + rows * PROFILER_ROW_HEIGHT + PROFILER_GRAPH_HEIGHT + PROFILER_ROW_HEIGHT;
+    int x = FIELD_MARGIN;
+    int y = input.screen_height - height - FIELD_MARGIN;
+    render_rectangle(x, y, PROFILER_WIDTH, height, PROFILER_PANEL_COLOR);
+
+    int frames_count = profiler_frames_count();
+    float total[PROFILE_SECTIONS] = {0};
+    float worst[PROFILE_SECTIONS] = {0};
+    int buckets[PROFILER_BUCKETS] = {0};
+    for (int i = 0; i < frames_count; ++i) {
+        const Profile_Frame *frame = profiler_frame(i);
+        for (int j = 0; j < PROFILE_SECTIONS; ++j) {
+            total[j] += frame->sections[j];
+            if (frame->sections[j] > worst[j]) worst[j] = frame->sections[j];
+        }
+        int bucket = frame->dt * 1000.0f / PROFILER_BUCKET_MS;
+        if (bucket >= PROFILER_BUCKETS) bucket = PROFILER_BUCKETS - 1;
+        if (bucket < 0) bucket = 0;
+        buckets[bucket] += 1;
+    }
+
+    int name_x = x + PROFILER_PADDING;
+    int average_x = x + PROFILER_WIDTH/2;
+    int worst_x = x + PROFILER_WIDTH*3/4;
+    int row_y = y + PROFILER_PADDING;
+    draw_text("section", name_x, row_y, PROFILER_FONT_SIZE, LETTER_COLOR);
+    draw_text("avg us", average_x, row_y, PROFILER_FONT_SIZE, LETTER_COLOR);
+    draw_text("max us", worst_x, row_y, PROFILER_FONT_SIZE, LETTER_COLOR);
+    for (int j = 0; j < PROFILE_SECTIONS; ++j) {
+        char text[12];
+        row_y += PROFILER_ROW_HEIGHT;
+        draw_text((char *) profile_section_names[j], name_x, row_y, PROFILER_FONT_SIZE, LETTER_COLOR);
+        int average = frames_count > 0 ? total[j] * 1e6f / frames_count : 0;
+        draw_text(int_to_text(average, text), average_x, row_y, PROFILER_FONT_SIZE, LETTER_COLOR);
+        draw_text(int_to_text(worst[j] * 1e6f, text), worst_x, row_y, PROFILER_FONT_SIZE, LETTER_COLOR);
+    }
+
+    int max_bucket = 1;
+    for (int i = 0; i < PROFILER_BUCKETS; ++i) {
+        if (buckets[i] > max_bucket) max_bucket = buckets[i];
+    }
+    int graph_y = row_y + PROFILER_ROW_HEIGHT + PROFILER_PADDING;
+    int bar_width = (PROFILER_WIDTH - PROFILER_PADDING*2) / PROFILER_BUCKETS;
+    for (int i = 0; i < PROFILER_BUCKETS; ++i) {
+        int bar_height = (float) PROFILER_GRAPH_HEIGHT * buckets[i] / max_bucket;
+        int bucket_ms = i * PROFILER_BUCKET_MS;
+        Color color = bucket_ms < 16 ? PROFILER_FAST_COLOR : bucket_ms < 33 ? PROFILER_SLOW_COLOR : PROFILER_STALL_COLOR;
+        render_rectangle(name_x + i * bar_width, graph_y + PROFILER_GRAPH_HEIGHT - bar_height, bar_width - 1, bar_height, color);
+    }
+    draw_text("0 ms", name_x, graph_y + PROFILER_GRAPH_HEIGHT, PROFILER_FONT_SIZE, LETTER_COLOR);
+    char last[16];
+    int_to_text(PROFILER_BUCKETS * PROFILER_BUCKET_MS, last);
+    int len = 0;
+    while (last[len] != '\0') ++len;
+    last[len] = '+';
+    last[len + 1] = '\0';
+    Vector2 last_size = render_measure_text(last, PROFILER_FONT_SIZE, 1);
+    draw_text(last, x + PROFILER_WIDTH - PROFILER_PADDING - last_size.x, graph_y + PROFILER_GRAPH_HEIGHT, PROFILER_FONT_SIZE, LETTER_COLOR);
+#endif // PROFILER_ENABLED
+}
+
+
+#if !defined(PLATFORM_WEB) && !defined(PLATFORM_HEADLESS)
+void save_trace(void)
+{
+    if (trace_dump(trace_path)) {
+        TraceLog(LOG_INFO, "Saved the trace to %s", trace_path);
+    } else {
+        TraceLog(LOG_ERROR, "Could not save the trace to %s", trace_path);
+    }
+}
+#endif
+
+
+void process_shortcuts(void)
 {
-    BeginDrawing();
-        ClearBackground(BACKGROUND_COLOR);
-        draw_game_state();
-        if (IsKeyDown(KEY_LEFT_SHIFT) && IsKeyPressed(KEY_R)) {
+    if (!input.shift) return;
+
+    for (int i = 0; i < input.keys_count; ++i) {
+        if (input.keys[i] == KEY_R) {
             game.state = STATE_RESTART_FADEIN;
             game.time = MAX_RESTART_TIMER;
-        } else if (IsKeyDown(KEY_LEFT_SHIFT) && IsKeyPressed(KEY_U)) {
-            for (int i = 0; i < WORD_LEN; ++i) {
-                game.current_guess[i].chr = '\0';
+            return;
+        } else if (input.keys[i] == KEY_U) {
+            for (int j = 0; j < WORD_LEN; ++j) {
+                game.current_guess[j].chr = '\0';
             }
             game.current_guess_len = 0;
+            outcomes_ready = false;
+            return;
+        } else if (input.keys[i] == KEY_C) {
+            candidates_panel.hidden = !candidates_panel.hidden;
+            /* Outcomes are only calculated while the panel is shown */
+            if (!candidates_panel.hidden && game.current_guess_len == WORD_LEN && !outcomes_ready) {
+                char guess[WORD_LEN];
+                for (int j = 0; j < WORD_LEN; ++j) guess[j] = game.current_guess[j].chr;
+                calculate_outcomes(guess);
+            }
+            return;
+        } else if (input.keys[i] == KEY_S) {
+            stats_visible = !stats_visible;
+            return;
+#ifdef PROFILER_ENABLED
+        } else if (input.keys[i] == KEY_P) {
+            profiler_visible = !profiler_visible;
+            return;
+        } else if (input.keys[i] == KEY_E) {
+            /* Replays and the headless tools take the key without writing
+             * files into the working directory */
+#ifndef PLATFORM_HEADLESS
+            if (profiler_export_csv(PROFILER_CSV_PATH)) {
+                TraceLog(LOG_INFO, "Saved the last frames to " PROFILER_CSV_PATH);
+            } else {
+                TraceLog(LOG_ERROR, "Could not save the last frames to " PROFILER_CSV_PATH);
+            }
+#endif
+            return;
+#endif
+#ifndef PLATFORM_WEB
+        } else if (input.keys[i] == KEY_D) {
+#ifndef PLATFORM_HEADLESS
+            save_trace();
+#endif
+            return;
+#endif
+        } else if (input.keys[i] == KEY_T) {
+            time_scale_index = (time_scale_index + 1) % ARRAY_LEN(time_scales);
+            time_scale = time_scales[time_scale_index].scale;
+            return;
         }
-    EndDrawing();
+    }
+}
+
+
+#ifndef PLATFORM_WEB
+#define RECORDING_MAGIC   0x43455257 // "WREC"
+#define RECORDING_VERSION 1
+
+/* A recording is a Recording_Header followed by a frame per game_frame. A
+ * frame is a byte of Recording_Flags, a byte with the number of keys, dt as
+ * a float, the fields the flags mark as changed and the keys as shorts, in
+ * the byte order of the machine that recorded it. */
+typedef enum Recording_Flags {
+    RECORDING_SHIFT          = 1 << 0,
+    RECORDING_MOUSE_PRESSED  = 1 << 1,
+    RECORDING_MOUSE_MOVED    = 1 << 2, // Followed by the mouse position as two floats
+    RECORDING_SCREEN_RESIZED = 1 << 3, // Followed by the screen size as two shorts
+    RECORDING_WHEEL          = 1 << 4, // Followed by the wheel movement as a float
+} Recording_Flags;
+
+typedef struct Recording_Header {
+    unsigned int magic;             // RECORDING_MAGIC
+    unsigned int version;           // RECORDING_VERSION
+    unsigned int seed;              // Seed of rand() for the whole session
+} Recording_Header;
+
+typedef struct Recording {
+    FILE *file;
+    Input previous;                 // Last frame written or read, unchanged fields are not stored
+} Recording;
+
+static Recording input_recording = {0};   // Written by game_frame when started with --record
+
+
+bool recording_open_for_write(Recording *recording, const char *path, unsigned int seed)
+{
+    *recording = (Recording) {0};
+    recording->file = fopen(path, "wb");
+    if (recording->file == NULL) return false;
+
+    Recording_Header header = { RECORDING_MAGIC, RECORDING_VERSION, seed };
+    return fwrite(&header, sizeof(header), 1, recording->file) == 1;
+}
+
+
+bool recording_open_for_read(Recording *recording, const char *path, unsigned int *seed)
+{
+    *recording = (Recording) {0};
+    recording->file = fopen(path, "rb");
+    if (recording->file == NULL) return false;
+
+    Recording_Header header;
+    if (fread(&header, sizeof(header), 1, recording->file) != 1 ||
+        header.magic != RECORDING_MAGIC || header.version != RECORDING_VERSION) {
+        fclose(recording->file);
+        recording->file = NULL;
+        return false;
+    }
+    *seed = header.seed;
+    return true;
+}
+
+
+void recording_close(Recording *recording)
+{
+    if (recording->file != NULL) fclose(recording->file);
+    recording->file = NULL;
+}
+
+
+bool recording_write_frame(Recording *recording, const Input *input)
+{
+    const Input *previous = &recording->previous;
+    unsigned char flags = 0;
+    if (input->shift) flags |= RECORDING_SHIFT;
+    if (input->mouse_pressed) flags |= RECORDING_MOUSE_PRESSED;
+    if (input->mouse.x != previous->mouse.x || input->mouse.y != previous->mouse.y) flags |= RECORDING_MOUSE_MOVED;
+    if (input->screen_width != previous->screen_width || input->screen_height != previous->screen_height) flags |= RECORDING_SCREEN_RESIZED;
+    if (input->wheel != 0.0f) flags |= RECORDING_WHEEL;
+
+    unsigned char frame[64];
+    size_t size = 0;
+    frame[size++] = flags;
+    frame[size++] = input->keys_count;
+    memcpy(frame + size, &input->dt, sizeof(float)); size += sizeof(float);
+    if (flags & RECORDING_MOUSE_MOVED) {
+        memcpy(frame + size, &input->mouse.x, sizeof(float)); size += sizeof(float);
+        memcpy(frame + size, &input->mouse.y, sizeof(float)); size += sizeof(float);
+    }
+    if (flags & RECORDING_SCREEN_RESIZED) {
+        unsigned short screen[2] = { input->screen_width, input->screen_height };
+        memcpy(frame + size, screen, sizeof(screen)); size += sizeof(screen);
+    }
+    if (flags & RECORDING_WHEEL) {
+        memcpy(frame + size, &input->wheel, sizeof(float)); size += sizeof(float);
+    }
+    if (fwrite(frame, 1, size, recording->file) != size) return false;
+
+    unsigned short keys[MAX_INPUT_KEYS];
+    for (int i = 0; i < input->keys_count; ++i) keys[i] = input->keys[i];
+    if (fwrite(keys, sizeof(keys[0]), input->keys_count, recording->file) != (size_t) input->keys_count) return false;
+
+    recording->previous = *input;
+    return true;
+}
+
+
+/* Returns false at the end of the recording */
+bool recording_read_frame(Recording *recording, Input *input)
+{
+    *input = recording->previous;
+
+    unsigned char header[2];
+    if (fread(header, 1, sizeof(header), recording->file) != sizeof(header)) return false;
+    unsigned char flags = header[0];
+    input->keys_count = header[1];
+    if (input->keys_count > MAX_INPUT_KEYS) return false;
+
+    if (fread(&input->dt, sizeof(float), 1, recording->file) != 1) return false;
+    input->shift = (flags & RECORDING_SHIFT) != 0;
+    input->mouse_pressed = (flags & RECORDING_MOUSE_PRESSED) != 0;
+    if (flags & RECORDING_MOUSE_MOVED) {
+        if (fread(&input->mouse.x, sizeof(float), 1, recording->file) != 1) return false;
+        if (fread(&input->mouse.y, sizeof(float), 1, recording->file) != 1) return false;
+    }
+    if (flags & RECORDING_SCREEN_RESIZED) {
+        unsigned short screen[2];
+        if (fread(screen, sizeof(screen[0]), 2, recording->file) != 2) return false;
+        input->screen_width = screen[0];
+        input->screen_height = screen[1];
+    }
+    input->wheel = 0.0f;
+    if (flags & RECORDING_WHEEL) {
+        if (fread(&input->wheel, sizeof(float), 1, recording->file) != 1) return false;
+    }
+
+    unsigned short keys[MAX_INPUT_KEYS];
+    if (fread(keys, sizeof(keys[0]), input->keys_count, recording->file) != (size_t) input->keys_count) return false;
+    for (int i = 0; i < input->keys_count; ++i) input->keys[i] = keys[i];
+
+    recording->previous = *input;
+    return true;
+}
+#endif // PLATFORM_WEB
+
+
+/* Handles the input of the frame once, then simulates its time in steps of
+ * UPDATE_STEP and keeps the remainder for the next frame. The game plays the
+ * same however often it is drawn. */
+void update_frame(void)
+{
+    if (game.state == STATE_PLAY) process_input();
+    if (game.state == STATE_PLAY) process_mouse();
+    scroll_candidates();
+    process_shortcuts();
+
+    update_time += input.dt;
+    if (update_time > MAX_UPDATE_TIME) update_time = MAX_UPDATE_TIME;
+    PROFILE_BEGIN(PROFILE_UPDATE);
+    while (update_time >= UPDATE_STEP) {
+        update(UPDATE_STEP);
+        update_time -= UPDATE_STEP;
+    }
+    PROFILE_END(PROFILE_UPDATE);
+
+    /* In instant mode run through every animation state within this frame */
+    if (time_scale <= 0.0f) skip_animations();
+}
+
+
+/* Draws the state as it is, without changing it */
+void draw_frame(void)
+{
+    render_begin();
+        render_clear(BACKGROUND_COLOR);
+        TRACE_SCOPE("draw_game_state") draw_game_state();
+        draw_candidates();
+        draw_time_scale();
+        draw_stats();
+        draw_profiler();
+    PROFILE_SCOPE(PROFILE_RENDER_END) render_end();
+}
+
+
+void game_frame(void)
+{
+    TRACE_BEGIN(game_frame);
+    poll_input();
+#ifndef PLATFORM_WEB
+    if (input_recording.file != NULL && !recording_write_frame(&input_recording, &input)) {
+        TraceLog(LOG_ERROR, "Could not write the recording, it is stopped");
+        recording_close(&input_recording);
+    }
+#endif
+    PROFILE_FRAME_BEGIN(input.dt);
+    PROFILE_BEGIN(PROFILE_FRAME);
+    update_frame();
+    draw_frame();
+    PROFILE_END(PROFILE_FRAME);
+    PROFILE_FRAME_END();
+    trace_counter("render_commands", render_buffer()->count);
+    TRACE_END(game_frame);
 }
 
 
+#ifndef PLATFORM_HEADLESS
+#ifdef PLATFORM_WEB
 int main(void)
 {
     srand(time(NULL));
+#else
+int main(int argc, char **argv)
+{
+    unsigned int seed = time(NULL);
+    srand(seed);
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            const char *path = argv[++i];
+            if (!recording_open_for_write(&input_recording, path, seed)) TraceLog(LOG_ERROR, "Could not record to %s", path);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+            atexit(save_trace);
+        }
+    }
+#endif
+    if (!stats_load(&stats)) TraceLog(LOG_WARNING, "Could not load the statistics");
     init_game();
 
     SetTraceLogLevel(LOG_WARNING);
     SetTargetFPS(60);
-    InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Wordle");
+    TRACE_SCOPE("InitWindow") InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Wordle");
 
-    font = LoadFontEx(LETTER_FONT_FILEPATH, LETTER_FONT_SIZE, NULL, 0);
+    Font letter_font;
+    TRACE_SCOPE("LoadFontEx") letter_font = LoadFontEx(LETTER_FONT_FILEPATH, LETTER_FONT_SIZE, NULL, 0);
+    render_set_font(letter_font);
 
 #ifdef PLATFORM_WEB
     raylib_js_set_entry(game_frame);
@@ -703,6 +1465,8 @@ int main(void)
         game_frame();
     }
     CloseWindow();
+    recording_close(&input_recording);
 #endif
     return 0;
 }
+#endif // PLATFORM_HEADLESS
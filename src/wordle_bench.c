@@ -0,0 +1,466 @@
+/* Times the hot paths of the game in isolation, without a window. The game
+ * is compiled in headless, so drawing goes to the null render backend and
+ * the frame benchmarks measure the game itself.
+ *
+ * Usage:
+ *   ./nob bench [--save-baseline] [OPTIONS]
+ *   ./build/wordle-bench [--json] [--repetitions N] [--filter NAME]
+ *                        [--commit ID] [--output FILE]
+ *                        [--baseline FILE] [--threshold PERCENT] [--alpha P]
+ *
+ * Every benchmark first runs for BENCH_WARMUP seconds, which also picks the
+ * number of iterations that takes about BENCH_BATCH seconds, and then times
+ * that many iterations --repetitions times. It prints the median, the fastest
+ * and the slowest repetition in nanoseconds per operation, or JSON with the
+ * mean and standard deviation too with --json. --output writes the JSON to a
+ * file, tagged with the --commit it was measured at. --filter runs the
+ * benchmarks whose name contains NAME.
+ *
+ * --baseline compares the run with the JSON of an earlier one using Welch's
+ * t-test. A benchmark regressed when its mean is more than --threshold
+ * percent slower and the difference is significant at --alpha, and any
+ * regression makes the exit code non-zero.
+ */
+#define PLATFORM_HEADLESS
+#include "wordle.c"
+
+#include <time.h>
+
+#define BENCH_WARMUP          0.1   // Seconds every benchmark runs before it is timed
+#define BENCH_BATCH           0.05  // Seconds a timed repetition takes
+#define BENCH_REPETITIONS     15
+#define BENCH_MAX_REPETITIONS 1000
+#define BENCH_ANSWER          "QUAIS"
+#define BENCH_THRESHOLD       5.0   // Percent a benchmark may get slower before it counts as a regression
+#define BENCH_ALPHA           0.01  // Significance level of the comparison with the baseline
+#define BENCH_MAX_RESULTS     64
+
+typedef struct Benchmark {
+    const char *name;
+    void (*setup)(void);
+    void (*run)(size_t iterations);
+    int ops;                        // Operations in one iteration of run
+} Benchmark;
+
+typedef struct Bench_Result {
+    char name[64];
+    double median;                  // Nanoseconds per operation
+    double min;
+    double max;
+    double mean;
+    double stddev;                  // Sample standard deviation of the repetitions
+    size_t iterations;              // Iterations in every repetition
+    int repetitions;
+} Bench_Result;
+
+/* Results are written here so the compiler cannot drop the work */
+static volatile int bench_sink = 0;
+
+static Game bench_game = {0};
+static Wordle_Candidates bench_candidates = {0};
+
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static void type_guess(const char *word)
+{
+    for (int i = 0; i < WORD_LEN; ++i) add_guess_letter(word[i]);
+}
+
+
+/* A fresh game with a fixed answer, so every run scores the same guesses */
+static void setup_game(void)
+{
+    srand(0);
+    stats_init(&stats);
+    init_game();
+    candidates_panel.hidden = true;
+    wordle_new_game(&game.rules, wordle_find_word(BENCH_ANSWER));
+}
+
+
+static void setup_typed_unknown_word(void)
+{
+    setup_game();
+    type_guess("QQQQQ");
+}
+
+
+/* Only the lookup of the word runs, the guess is rejected and nothing changes */
+static void run_make_attempt_unknown_word(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i) bench_sink += make_attempt();
+}
+
+
+static void setup_typed_word(void)
+{
+    setup_game();
+    type_guess("CRANE");
+    bench_game = game;
+    bench_candidates = candidates;
+}
+
+
+/* The accepted guess colors the keyboard and filters the candidates. Every
+ * iteration restores the game and the candidates first, which is a copy of
+ * about sizeof(Wordle_Candidates) bytes. */
+static void run_make_attempt_accepted(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i) {
+        game = bench_game;
+        candidates = bench_candidates;
+        bench_sink += make_attempt();
+    }
+}
+
+
+static void run_find_keyboard_key(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i) {
+        for (char chr = 'A'; chr <= 'Z'; ++chr) {
+            int row, col;
+            bench_sink += find_keyboard_key(chr, &row, &col) ? row + col : 0;
+        }
+    }
+}
+
+
+static void run_restart_game(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i) {
+        restart_game();
+        bench_sink += game.rules.answer;
+    }
+}
+
+
+/* The game waits for input with three guesses on the board */
+static void setup_frame(void)
+{
+    setup_game();
+    const char *guesses[] = { "CRANE", "SLOTH", "PUDGY" };
+    for (size_t i = 0; i < ARRAY_LEN(guesses); ++i) {
+        type_guess(guesses[i]);
+        submit_guess();
+        skip_animations();
+    }
+    type_guess("QUA");
+    input = (Input) {
+        .dt = 1.0f/60.0f,
+        .screen_width = 800,
+        .screen_height = 600,
+    };
+}
+
+
+static void run_update_frame(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i) update_frame();
+    bench_sink += game.state;
+}
+
+
+static void run_frame(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i) {
+        update_frame();
+        draw_frame();
+    }
+    bench_sink += render_buffer()->count;
+}
+
+
+static Benchmark benchmarks[] = {
+    { "make_attempt/unknown_word", setup_typed_unknown_word, run_make_attempt_unknown_word, 1 },
+    { "make_attempt/accepted",     setup_typed_word,         run_make_attempt_accepted,     1 },
+    { "find_keyboard_key",         setup_game,               run_find_keyboard_key,         26 },
+    { "restart_game",              setup_game,               run_restart_game,              1 },
+    { "frame/update",              setup_frame,              run_update_frame,              1 },
+    { "frame/update_draw",         setup_frame,              run_frame,                     1 },
+};
+
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+
+static Bench_Result run_benchmark(const Benchmark *benchmark, int repetitions)
+{
+    benchmark->setup();
+
+    /* Doubles the iterations until a batch is long enough, which warms up the
+     * caches and the branch predictors on the way */
+    size_t iterations = 1;
+    double warmup_start = now_seconds();
+    for (;;) {
+        double start = now_seconds();
+        benchmark->run(iterations);
+        double elapsed = now_seconds() - start;
+        if (elapsed >= BENCH_BATCH) {
+            if (now_seconds() - warmup_start >= BENCH_WARMUP) break;
+        } else {
+            iterations *= 2;
+        }
+    }
+
+    double samples[BENCH_MAX_REPETITIONS];
+    double sum = 0.0;
+    for (int r = 0; r < repetitions; ++r) {
+        double start = now_seconds();
+        benchmark->run(iterations);
+        samples[r] = (now_seconds() - start) * 1e9 / ((double) iterations * benchmark->ops);
+        sum += samples[r];
+    }
+    qsort(samples, repetitions, sizeof(samples[0]), compare_doubles);
+
+    Bench_Result result = {
+        .median = repetitions % 2 ? samples[repetitions/2] : (samples[repetitions/2 - 1] + samples[repetitions/2]) / 2.0,
+        .min = samples[0],
+        .max = samples[repetitions - 1],
+        .mean = sum / repetitions,
+        .iterations = iterations,
+        .repetitions = repetitions,
+    };
+    double squares = 0.0;
+    for (int r = 0; r < repetitions; ++r) squares += (samples[r] - result.mean) * (samples[r] - result.mean);
+    result.stddev = repetitions > 1 ? sqrt(squares / (repetitions - 1)) : 0.0;
+    snprintf(result.name, sizeof(result.name), "%s", benchmark->name);
+    return result;
+}
+
+
+static void write_json(FILE *file, const char *commit, const Bench_Result *results, int count)
+{
+    fprintf(file, "{\n  \"commit\": \"%s\",\n  \"benchmarks\": [", commit);
+    for (int i = 0; i < count; ++i) {
+        const Bench_Result *result = &results[i];
+        fprintf(file, "%s\n    {\"name\": \"%s\", \"median_ns\": %.3f, \"min_ns\": %.3f, \"max_ns\": %.3f, \"mean_ns\": %.3f, \"stddev_ns\": %.3f, \"iterations\": %zu, \"repetitions\": %d}",
+                i == 0 ? "" : ",", result->name, result->median, result->min, result->max, result->mean, result->stddev, result->iterations, result->repetitions);
+    }
+    fprintf(file, "\n  ]\n}\n");
+}
+
+
+static bool json_number(const char *line, const char *key, double *value)
+{
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\": ", key);
+    const char *start = strstr(line, pattern);
+    if (start == NULL) return false;
+    *value = strtod(start + strlen(pattern), NULL);
+    return true;
+}
+
+
+/* Reads the JSON written by write_json, a benchmark per line */
+static int read_json(const char *path, char *commit, size_t commit_size, Bench_Result *results, int capacity)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) return -1;
+
+    int count = 0;
+    char line[1024];
+    snprintf(commit, commit_size, "unknown");
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char value[64];
+        if (sscanf(line, " \"commit\": \"%63[^\"]\"", value) == 1) snprintf(commit, commit_size, "%s", value);
+        if (sscanf(line, " {\"name\": \"%63[^\"]\"", value) != 1 || count >= capacity) continue;
+
+        Bench_Result *result = &results[count];
+        *result = (Bench_Result) {0};
+        snprintf(result->name, sizeof(result->name), "%s", value);
+        double repetitions = 0.0;
+        if (!json_number(line, "mean_ns", &result->mean)) continue;
+        if (!json_number(line, "stddev_ns", &result->stddev)) continue;
+        if (!json_number(line, "repetitions", &repetitions)) continue;
+        json_number(line, "median_ns", &result->median);
+        result->repetitions = repetitions;
+        count += 1;
+    }
+    fclose(file);
+    return count;
+}
+
+
+/* Continued fraction of the regularized incomplete beta function, from
+ * Numerical Recipes */
+static double beta_fraction(double a, double b, double x)
+{
+    const double tiny = 1e-300;
+    double c = 1.0;
+    double d = 1.0 - (a + b) * x / (a + 1.0);
+    if (fabs(d) < tiny) d = tiny;
+    d = 1.0 / d;
+    double h = d;
+    for (int m = 1; m <= 200; ++m) {
+        double m2 = 2.0 * m;
+        double aa = m * (b - m) * x / ((a + m2 - 1.0) * (a + m2));
+        d = 1.0 + aa * d;
+        if (fabs(d) < tiny) d = tiny;
+        c = 1.0 + aa / c;
+        if (fabs(c) < tiny) c = tiny;
+        d = 1.0 / d;
+        h *= d * c;
+        aa = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1.0));
+        d = 1.0 + aa * d;
+        if (fabs(d) < tiny) d = tiny;
+        c = 1.0 + aa / c;
+        if (fabs(c) < tiny) c = tiny;
+        d = 1.0 / d;
+        double delta = d * c;
+        h *= delta;
+        if (fabs(delta - 1.0) < 1e-12) break;
+    }
+    return h;
+}
+
+
+static double incomplete_beta(double a, double b, double x)
+{
+    if (x <= 0.0) return 0.0;
+    if (x >= 1.0) return 1.0;
+    double front = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log(1.0 - x));
+    if (x < (a + 1.0) / (a + b + 2.0)) return front * beta_fraction(a, b, x) / a;
+    return 1.0 - front * beta_fraction(b, a, 1.0 - x) / b;
+}
+
+
+/* Two sided p-value of Welch's t-test for the means of two runs */
+static double welch_p_value(const Bench_Result *a, const Bench_Result *b)
+{
+    if (a->repetitions < 2 || b->repetitions < 2) return 1.0;
+    double va = a->stddev * a->stddev / a->repetitions;
+    double vb = b->stddev * b->stddev / b->repetitions;
+    if (va + vb <= 0.0) return a->mean == b->mean ? 1.0 : 0.0;
+
+    double t = (a->mean - b->mean) / sqrt(va + vb);
+    double df = (va + vb) * (va + vb) / (va * va / (a->repetitions - 1) + vb * vb / (b->repetitions - 1));
+    return incomplete_beta(df / 2.0, 0.5, df / (df + t * t));
+}
+
+
+/* Prints how every benchmark changed against the baseline and returns the
+ * number of regressions */
+static int compare_with_baseline(const char *path, const Bench_Result *results, int count, double threshold, double alpha)
+{
+    static Bench_Result baseline[BENCH_MAX_RESULTS];
+    char commit[64];
+    int baseline_count = read_json(path, commit, sizeof(commit), baseline, BENCH_MAX_RESULTS);
+    if (baseline_count < 0) {
+        fprintf(stderr, "ERROR: could not read the baseline %s\n", path);
+        return 1;
+    }
+
+    printf("\ncompared with %s (%s), regression is > %.1f%% slower at p < %g\n", path, commit, threshold, alpha);
+    printf("%-28s %12s %12s %9s %10s\n", "benchmark", "baseline ns", "mean ns", "change", "p-value");
+    int regressions = 0;
+    for (int i = 0; i < count; ++i) {
+        const Bench_Result *result = &results[i];
+        const Bench_Result *base = NULL;
+        for (int j = 0; j < baseline_count; ++j) {
+            if (strcmp(baseline[j].name, result->name) == 0) base = &baseline[j];
+        }
+        if (base == NULL) {
+            printf("%-28s %12s %12.1f %9s %10s  new\n", result->name, "-", result->mean, "-", "-");
+            continue;
+        }
+
+        double change = base->mean > 0.0 ? (result->mean - base->mean) * 100.0 / base->mean : 0.0;
+        double p = welch_p_value(result, base);
+        const char *verdict = "";
+        if (p < alpha && change > threshold) {
+            verdict = "REGRESSION";
+            regressions += 1;
+        } else if (p < alpha && change > 0.0) {
+            verdict = "slower";
+        } else if (p < alpha && change < 0.0) {
+            verdict = "faster";
+        }
+        printf("%-28s %12.1f %12.1f %+8.1f%% %10.4f  %s\n", result->name, base->mean, result->mean, change, p, verdict);
+    }
+    return regressions;
+}
+
+
+int main(int argc, char **argv)
+{
+    bool json = false;
+    int repetitions = BENCH_REPETITIONS;
+    const char *filter = NULL;
+    const char *commit = "unknown";
+    const char *output_path = NULL;
+    const char *baseline_path = NULL;
+    double threshold = BENCH_THRESHOLD;
+    double alpha = BENCH_ALPHA;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            repetitions = atoi(argv[++i]);
+            if (repetitions < 1) repetitions = 1;
+            if (repetitions > BENCH_MAX_REPETITIONS) repetitions = BENCH_MAX_REPETITIONS;
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--commit") == 0 && i + 1 < argc) {
+            commit = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--alpha") == 0 && i + 1 < argc) {
+            alpha = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--json] [--repetitions N] [--filter NAME] [--commit ID] [--output FILE]\n"
+                            "       [--baseline FILE] [--threshold PERCENT] [--alpha P]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    static Bench_Result results[BENCH_MAX_RESULTS];
+    int count = 0;
+    if (!json) printf("%-28s %12s %12s %12s\n", "benchmark", "median ns", "min ns", "max ns");
+    for (size_t i = 0; i < ARRAY_LEN(benchmarks); ++i) {
+        const Benchmark *benchmark = &benchmarks[i];
+        if (filter != NULL && strstr(benchmark->name, filter) == NULL) continue;
+
+        Bench_Result *result = &results[count++];
+        *result = run_benchmark(benchmark, repetitions);
+        if (!json) {
+            printf("%-28s %12.1f %12.1f %12.1f\n", result->name, result->median, result->min, result->max);
+            fflush(stdout);
+        }
+    }
+    if (json) write_json(stdout, commit, results, count);
+
+    if (output_path != NULL) {
+        FILE *file = fopen(output_path, "w");
+        if (file == NULL) {
+            fprintf(stderr, "ERROR: could not write %s\n", output_path);
+            return 1;
+        }
+        write_json(file, commit, results, count);
+        fclose(file);
+    }
+
+    if (baseline_path != NULL) {
+        int regressions = compare_with_baseline(baseline_path, results, count, threshold, alpha);
+        if (regressions > 0) {
+            fprintf(stderr, "ERROR: %d benchmark(s) regressed against %s\n", regressions, baseline_path);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,298 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "libwordle.h"
+
+// Headless Wordle for bots, spoken over stdin and stdout.
+//
+//     wordle-bot [--seed N]
+//
+// Every message is a 16 byte frame, integers are little endian. A bot may
+// send any number of requests before reading the responses. Responses come
+// in the order of the requests. Games are identified by IDs the bot picks,
+// so any number of games can be in flight at once.
+//
+// Request:
+//     u32 game_id
+//     u8  op           BOT_OP_*
+//     u8  reserved[3]
+//     u8  payload[8]   BOT_OP_NEW:   u32 answer index, 0xFFFFFFFF for a random one
+//                      BOT_OP_GUESS: WORD_LEN letters in upper case
+//
+// Response:
+//     u32 game_id
+//     u8  op           Same as in the request
+//     u8  result       BOT_RESULT_*
+//     u8  status       Wordle_Status of the game
+//     u8  attempt      Number of accepted guesses
+//     u8  pattern      Feedback of the guess as wordle_feedback_pattern, the
+//                      first letter is the lowest base 3 digit: 0 wrong,
+//                      1 misplaced, 2 correct
+//     u8  reserved[3]
+//     u32 answer       Index of the answer once the game is over, else 0xFFFFFFFF
+
+#define FRAME_SIZE      16
+#define IO_BUFFER_SIZE  (FRAME_SIZE*4096)
+#define NO_ANSWER       0xFFFFFFFFu
+
+typedef enum Bot_Op {
+    BOT_OP_NEW = 1,                 // Start a game under the ID, replacing a finished one
+    BOT_OP_GUESS = 2,               // Submit a guess
+    BOT_OP_END = 3,                 // Forget the game and free its ID
+} Bot_Op;
+
+typedef enum Bot_Result {
+    BOT_RESULT_OK = 0,
+    BOT_RESULT_INCOMPLETE,          // Same as WORDLE_GUESS_INCOMPLETE
+    BOT_RESULT_UNKNOWN_WORD,        // Same as WORDLE_GUESS_UNKNOWN_WORD
+    BOT_RESULT_GAME_OVER,           // Same as WORDLE_GUESS_GAME_OVER
+    BOT_RESULT_UNKNOWN_GAME,        // No game with the ID
+    BOT_RESULT_GAME_EXISTS,         // A game with the ID is still being played
+    BOT_RESULT_BAD_REQUEST,         // Unknown op or answer index out of range
+} Bot_Result;
+
+typedef struct Slot {
+    unsigned int id;
+    bool used;
+    Wordle_Game game;
+} Slot;
+
+/* Open addressing with linear probing and backward shift deletion */
+typedef struct Games {
+    Slot *items;
+    size_t count;
+    size_t capacity;                // Always a power of two
+} Games;
+
+static Games games = {0};
+static unsigned long long rng_state = 0x9E3779B97F4A7C15ull;
+
+
+unsigned int random_answer(void)
+{
+    /* xorshift64* */
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (rng_state * 0x2545F4914F6CDD1Dull >> 32) % WORDS;
+}
+
+
+size_t hash_id(unsigned int id)
+{
+    return (id * 0x9E3779B1u) & (games.capacity - 1);
+}
+
+
+Slot *find_game(unsigned int id)
+{
+    if (games.capacity == 0) return NULL;
+    for (size_t i = hash_id(id);; i = (i + 1) & (games.capacity - 1)) {
+        if (!games.items[i].used) return NULL;
+        if (games.items[i].id == id) return &games.items[i];
+    }
+}
+
+
+Slot *insert_game(unsigned int id);
+
+void grow_games(void)
+{
+    Games old = games;
+    games.capacity = old.capacity == 0 ? 1024 : old.capacity*2;
+    games.items = calloc(games.capacity, sizeof(*games.items));
+    games.count = 0;
+    if (games.items == NULL) {
+        fprintf(stderr, "ERROR: out of memory\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < old.capacity; ++i) {
+        if (!old.items[i].used) continue;
+        *insert_game(old.items[i].id) = old.items[i];
+    }
+    free(old.items);
+}
+
+
+Slot *insert_game(unsigned int id)
+{
+    if ((games.count + 1)*4 > games.capacity*3) grow_games();
+    size_t i = hash_id(id);
+    while (games.items[i].used) i = (i + 1) & (games.capacity - 1);
+    games.items[i].used = true;
+    games.items[i].id = id;
+    games.count += 1;
+    return &games.items[i];
+}
+
+
+void remove_game(Slot *slot)
+{
+    size_t mask = games.capacity - 1;
+    size_t hole = slot - games.items;
+    games.items[hole].used = false;
+    games.count -= 1;
+
+    /* Shift back the following entries that can move closer to their home */
+    for (size_t i = (hole + 1) & mask; games.items[i].used; i = (i + 1) & mask) {
+        size_t home = hash_id(games.items[i].id);
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            games.items[hole] = games.items[i];
+            games.items[i].used = false;
+            hole = i;
+        }
+    }
+}
+
+
+unsigned int read_u32(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int) p[3] << 24);
+}
+
+
+void write_u32(unsigned char *p, unsigned int value)
+{
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+}
+
+
+Bot_Result new_game(unsigned int id, unsigned int answer, Slot **slot)
+{
+    if (answer == NO_ANSWER) answer = random_answer();
+    if (answer >= WORDS) return BOT_RESULT_BAD_REQUEST;
+
+    *slot = find_game(id);
+    if (*slot != NULL && wordle_game_status(&(*slot)->game) == WORDLE_STATUS_PLAYING) return BOT_RESULT_GAME_EXISTS;
+    if (*slot == NULL) *slot = insert_game(id);
+
+    wordle_new_game(&(*slot)->game, answer);
+    return BOT_RESULT_OK;
+}
+
+
+Bot_Result guess(unsigned int id, const unsigned char *payload, Slot **slot)
+{
+    *slot = find_game(id);
+    if (*slot == NULL) return BOT_RESULT_UNKNOWN_GAME;
+
+    switch (wordle_submit_guess(&(*slot)->game, (const char *) payload)) {
+        case WORDLE_GUESS_ACCEPTED:     return BOT_RESULT_OK;
+        case WORDLE_GUESS_INCOMPLETE:   return BOT_RESULT_INCOMPLETE;
+        case WORDLE_GUESS_UNKNOWN_WORD: return BOT_RESULT_UNKNOWN_WORD;
+        case WORDLE_GUESS_GAME_OVER:    return BOT_RESULT_GAME_OVER;
+    }
+    return BOT_RESULT_BAD_REQUEST;
+}
+
+
+void handle_frame(const unsigned char *request, unsigned char *response)
+{
+    unsigned int id = read_u32(request);
+    unsigned char op = request[4];
+    const unsigned char *payload = request + 8;
+
+    Slot *slot = NULL;
+    Bot_Result result = BOT_RESULT_BAD_REQUEST;
+    bool accepted_guess = false;
+    switch (op) {
+        case BOT_OP_NEW: {
+            result = new_game(id, read_u32(payload), &slot);
+        } break;
+        case BOT_OP_GUESS: {
+            result = guess(id, payload, &slot);
+            accepted_guess = result == BOT_RESULT_OK;
+        } break;
+        case BOT_OP_END: {
+            slot = find_game(id);
+            if (slot == NULL) {
+                result = BOT_RESULT_UNKNOWN_GAME;
+            } else {
+                remove_game(slot);
+                slot = NULL;
+                result = BOT_RESULT_OK;
+            }
+        } break;
+    }
+
+    memset(response, 0, FRAME_SIZE);
+    write_u32(response, id);
+    response[4] = op;
+    response[5] = result;
+    write_u32(response + 12, NO_ANSWER);
+    if (slot == NULL) return;
+
+    Wordle_Game *game = &slot->game;
+    response[6] = wordle_game_status(game);
+    response[7] = game->attempt;
+    if (accepted_guess) response[8] = game->patterns[game->attempt - 1];
+    if (wordle_game_status(game) != WORDLE_STATUS_PLAYING) write_u32(response + 12, game->answer);
+}
+
+
+bool write_all(const unsigned char *data, size_t size)
+{
+    while (size > 0) {
+        ssize_t n = write(STDOUT_FILENO, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            rng_state = strtoull(argv[++i], NULL, 10) | 1;
+        } else {
+            fprintf(stderr, "Usage: %s [--seed N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    static unsigned char input[IO_BUFFER_SIZE];
+    static unsigned char output[IO_BUFFER_SIZE];
+    size_t pending = 0;
+    for (;;) {
+        ssize_t n = read(STDIN_FILENO, input + pending, IO_BUFFER_SIZE - pending);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "ERROR: could not read requests: %s\n", strerror(errno));
+            return 1;
+        }
+        if (n == 0) break;
+        pending += n;
+
+        /* Everything that has arrived is answered with a single write */
+        size_t frames = pending / FRAME_SIZE;
+        for (size_t i = 0; i < frames; ++i) {
+            handle_frame(input + i*FRAME_SIZE, output + i*FRAME_SIZE);
+        }
+        if (!write_all(output, frames*FRAME_SIZE)) {
+            fprintf(stderr, "ERROR: could not write responses: %s\n", strerror(errno));
+            return 1;
+        }
+
+        pending -= frames*FRAME_SIZE;
+        memmove(input, input + frames*FRAME_SIZE, pending);
+    }
+
+    if (pending > 0) {
+        fprintf(stderr, "ERROR: input ended in the middle of a frame\n");
+        return 1;
+    }
+    return 0;
+}
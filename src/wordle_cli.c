@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "libwordle.h"
+
+// Streams Wordle feedback for guesses read from stdin.
+//
+//     wordle-cli [--strict] [--answer WORD]
+//
+// Without --answer every input line is `GUESS ANSWER` and one pattern is
+// printed per line. With --answer every input line is a list of guesses and
+// the patterns of all of them against WORD are printed on one line. Blank
+// lines print an empty line, so the output always lines up with the input.
+//
+// A pattern has a character per letter: G for the right place, Y for the
+// wrong place and . for a letter not in the answer. With --strict guesses
+// that are not in the word list are rejected like the game does. Lines that
+// cannot be scored produce ????? and make the exit code non-zero.
+
+#define INPUT_BUFFER_SIZE  (1024*1024)
+#define OUTPUT_BUFFER_SIZE (1024*1024)
+#define BATCH_SIZE         4096
+
+typedef struct Batch {
+    char guesses[BATCH_SIZE][WORD_LEN];
+    char answers[BATCH_SIZE][WORD_LEN];
+    bool valid[BATCH_SIZE];
+    char separators[BATCH_SIZE];    // Printed after the pattern, ' ' or '\n'
+    int count;
+} Batch;
+
+typedef struct Output {
+    char items[OUTPUT_BUFFER_SIZE];
+    size_t count;
+} Output;
+
+static char input_buffer[INPUT_BUFFER_SIZE];
+static Batch batch = {0};
+static Output output = {0};
+static bool strict = false;
+static bool failed = false;
+
+static const char pattern_chars[] = {
+    [WORDLE_FEEDBACK_WRONG]     = '.',
+    [WORDLE_FEEDBACK_MISPLACED] = 'Y',
+    [WORDLE_FEEDBACK_CORRECT]   = 'G',
+};
+
+
+void flush_output(void)
+{
+    fwrite(output.items, 1, output.count, stdout);
+    output.count = 0;
+}
+
+
+/* Scores the whole batch in one tight loop before formatting it */
+void flush_batch(void)
+{
+    static Wordle_Feedback feedback[BATCH_SIZE][WORD_LEN];
+    for (int i = 0; i < batch.count; ++i) {
+        wordle_score(batch.guesses[i], batch.answers[i], feedback[i]);
+    }
+
+    for (int i = 0; i < batch.count; ++i) {
+        if (output.count + WORD_LEN + 1 > OUTPUT_BUFFER_SIZE) flush_output();
+        char *out = &output.items[output.count];
+        for (int j = 0; j < WORD_LEN; ++j) {
+            out[j] = batch.valid[i] ? pattern_chars[feedback[i][j]] : '?';
+        }
+        out[WORD_LEN] = batch.separators[i];
+        output.count += WORD_LEN + 1;
+    }
+    batch.count = 0;
+}
+
+
+/* Copies a word in upper case, returns false if it is not WORD_LEN letters */
+bool parse_word(const char *begin, const char *end, char *word)
+{
+    if (end - begin != WORD_LEN) return false;
+    for (int i = 0; i < WORD_LEN; ++i) {
+        char c = begin[i];
+        if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+        if (c < 'A' || c > 'Z') return false;
+        word[i] = c;
+    }
+    return true;
+}
+
+
+void push_pair(const char *guess, const char *answer, bool valid, char separator)
+{
+    if (valid && strict && wordle_find_word(guess) < 0) valid = false;
+    if (!valid) failed = true;
+
+    memcpy(batch.guesses[batch.count], guess, WORD_LEN);
+    memcpy(batch.answers[batch.count], answer, WORD_LEN);
+    batch.valid[batch.count] = valid;
+    batch.separators[batch.count] = separator;
+    if (++batch.count == BATCH_SIZE) flush_batch();
+}
+
+
+const char *skip_spaces(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+    return p;
+}
+
+
+const char *skip_word(const char *p, const char *end)
+{
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\r') ++p;
+    return p;
+}
+
+
+void process_line(const char *line, const char *line_end, const char *answer)
+{
+    const char *p = skip_spaces(line, line_end);
+    if (p == line_end) {
+        flush_batch();
+        if (output.count + 1 > OUTPUT_BUFFER_SIZE) flush_output();
+        output.items[output.count++] = '\n';
+        return;
+    }
+
+    char guess[WORD_LEN] = {0};
+    if (answer == NULL) {
+        char pair_answer[WORD_LEN] = {0};
+        const char *guess_end = skip_word(p, line_end);
+        const char *answer_begin = skip_spaces(guess_end, line_end);
+        const char *answer_end = skip_word(answer_begin, line_end);
+        bool valid = skip_spaces(answer_end, line_end) == line_end;
+        valid = valid && parse_word(p, guess_end, guess);
+        valid = valid && parse_word(answer_begin, answer_end, pair_answer);
+        push_pair(guess, pair_answer, valid, '\n');
+        return;
+    }
+
+    while (p < line_end) {
+        const char *word_end = skip_word(p, line_end);
+        bool valid = parse_word(p, word_end, guess);
+        p = skip_spaces(word_end, line_end);
+        push_pair(guess, answer, valid, p < line_end ? ' ' : '\n');
+    }
+}
+
+
+void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--strict] [--answer WORD]\n", program);
+    fprintf(stderr, "    Reads `GUESS ANSWER` lines, or lines of guesses with --answer,\n");
+    fprintf(stderr, "    and prints a feedback pattern per guess: G right place, Y wrong place, . absent\n");
+}
+
+
+int main(int argc, char **argv)
+{
+    const char *program = argv[0];
+    char answer[WORD_LEN] = {0};
+    bool has_answer = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--strict") == 0) {
+            strict = true;
+        } else if (strcmp(argv[i], "--answer") == 0 && i + 1 < argc) {
+            const char *word = argv[++i];
+            if (!parse_word(word, word + strlen(word), answer)) {
+                fprintf(stderr, "ERROR: answer must be %d letters\n", WORD_LEN);
+                return 1;
+            }
+            has_answer = true;
+        } else {
+            usage(program);
+            return 1;
+        }
+    }
+
+    /* Lines may cross the end of a read, the unfinished tail is moved to
+     * the front of the buffer before the next read */
+    size_t pending = 0;
+    for (;;) {
+        size_t n = fread(input_buffer + pending, 1, INPUT_BUFFER_SIZE - pending, stdin);
+        size_t size = pending + n;
+        bool eof = n == 0;
+
+        const char *line = input_buffer;
+        const char *end = input_buffer + size;
+        for (;;) {
+            const char *newline = memchr(line, '\n', end - line);
+            if (newline == NULL) break;
+            process_line(line, newline, has_answer ? answer : NULL);
+            line = newline + 1;
+        }
+
+        pending = end - line;
+        if (eof) {
+            if (pending > 0) process_line(line, end, has_answer ? answer : NULL);
+            break;
+        }
+        if (pending == INPUT_BUFFER_SIZE) {
+            fprintf(stderr, "ERROR: input line is longer than %d bytes\n", INPUT_BUFFER_SIZE);
+            return 1;
+        }
+        memmove(input_buffer, line, pending);
+    }
+
+    flush_batch();
+    flush_output();
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,242 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "libwordle.h"
+
+// Differential test of the scoring of the game against a reference scorer.
+//
+//     wordle-fuzz [--threads N] [--random N] [--seed N]
+//
+// Every guess in the word list is scored against every answer in it with
+// wordle_score and with the reference below, which counts letters instead of
+// clearing them like wordle_score does. The feedback pattern has to survive
+// wordle_feedback_pattern and wordle_pattern_feedback too. A sample of the
+// pairs is also played through wordle_submit_guess, the way the game colors
+// a guess. Then --random pairs of random strings over a small alphabet are
+// compared, so most of them repeat letters in both words.
+//
+// The work is split between --threads threads, one per core by default. The
+// first mismatches are printed and make the exit code non-zero.
+
+#define DEFAULT_RANDOM      (10*1000*1000)
+#define RANDOM_ALPHABET     "ABCDE"
+#define GAME_SAMPLE_PERIOD  97      // Every pair with (guess + answer) % period == 0 is played as a game
+#define MAX_THREADS         256
+#define MAX_REPORTED        10
+
+typedef struct Shard {
+    pthread_t thread;
+    int index;
+    int count;                          // Number of shards
+    unsigned long long seed;
+    unsigned long long random;          // Random pairs of this shard
+    unsigned long long checked;         // Pairs compared
+    unsigned long long mismatches;
+} Shard;
+
+static pthread_mutex_t report_lock = PTHREAD_MUTEX_INITIALIZER;
+static int reported = 0;
+
+
+/* Letters in the right place are green. Every other letter of the guess is
+ * yellow while the answer has more unmatched copies of it than the guess
+ * used up to the left of it. */
+static void reference_score(const char *guess, const char *answer, Wordle_Feedback feedback[WORD_LEN])
+{
+    int unmatched[256] = {0};
+    for (int i = 0; i < WORD_LEN; ++i) {
+        if (guess[i] != answer[i]) unmatched[(unsigned char) answer[i]] += 1;
+    }
+    for (int i = 0; i < WORD_LEN; ++i) {
+        if (guess[i] == answer[i]) {
+            feedback[i] = WORDLE_FEEDBACK_CORRECT;
+        } else if (unmatched[(unsigned char) guess[i]] > 0) {
+            unmatched[(unsigned char) guess[i]] -= 1;
+            feedback[i] = WORDLE_FEEDBACK_MISPLACED;
+        } else {
+            feedback[i] = WORDLE_FEEDBACK_WRONG;
+        }
+    }
+}
+
+
+static void format_feedback(const Wordle_Feedback feedback[WORD_LEN], char pattern[WORD_LEN + 1])
+{
+    for (int i = 0; i < WORD_LEN; ++i) pattern[i] = ".YG"[feedback[i]];
+    pattern[WORD_LEN] = '\0';
+}
+
+
+static void report(const char *what, const char *guess, const char *answer,
+                   const Wordle_Feedback expected[WORD_LEN], const Wordle_Feedback actual[WORD_LEN])
+{
+    pthread_mutex_lock(&report_lock);
+    if (reported < MAX_REPORTED) {
+        char expected_pattern[WORD_LEN + 1];
+        char actual_pattern[WORD_LEN + 1];
+        format_feedback(expected, expected_pattern);
+        format_feedback(actual, actual_pattern);
+        fprintf(stderr, "MISMATCH: %s: guess %.*s answer %.*s: expected %s, got %s\n",
+                what, WORD_LEN, guess, WORD_LEN, answer, expected_pattern, actual_pattern);
+    }
+    reported += 1;
+    pthread_mutex_unlock(&report_lock);
+}
+
+
+static bool same_feedback(const Wordle_Feedback a[WORD_LEN], const Wordle_Feedback b[WORD_LEN])
+{
+    for (int i = 0; i < WORD_LEN; ++i) {
+        if (a[i] != b[i]) return false;
+    }
+    return true;
+}
+
+
+/* Returns the number of mismatches, 0 or 1 */
+static int check_pair(const char *guess, const char *answer, bool pattern)
+{
+    Wordle_Feedback expected[WORD_LEN];
+    Wordle_Feedback actual[WORD_LEN];
+    reference_score(guess, answer, expected);
+    wordle_score(guess, answer, actual);
+    if (!same_feedback(expected, actual)) {
+        report("wordle_score", guess, answer, expected, actual);
+        return 1;
+    }
+    if (pattern) {
+        wordle_pattern_feedback(wordle_feedback_pattern(actual), actual);
+        if (!same_feedback(expected, actual)) {
+            report("feedback pattern", guess, answer, expected, actual);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+static int check_game(int guess, int answer)
+{
+    Wordle_Game game;
+    wordle_new_game(&game, answer);
+    Wordle_Feedback expected[WORD_LEN];
+    Wordle_Feedback actual[WORD_LEN] = {0};
+    reference_score(wordle_word(guess), wordle_word(answer), expected);
+    if (wordle_submit_guess(&game, wordle_word(guess)) == WORDLE_GUESS_ACCEPTED) {
+        wordle_game_feedback(&game, 0, actual);
+        if (same_feedback(expected, actual)) return 0;
+    }
+    report("wordle_submit_guess", wordle_word(guess), wordle_word(answer), expected, actual);
+    return 1;
+}
+
+
+static unsigned long long xorshift64(unsigned long long *state)
+{
+    unsigned long long x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+
+static void random_word(unsigned long long *state, char word[WORD_LEN])
+{
+    unsigned long long bits = xorshift64(state);
+    for (int i = 0; i < WORD_LEN; ++i) {
+        word[i] = RANDOM_ALPHABET[bits % (sizeof(RANDOM_ALPHABET) - 1)];
+        bits /= sizeof(RANDOM_ALPHABET) - 1;
+    }
+}
+
+
+/* Answers are dealt to the shards round robin, every shard takes all the
+ * guesses against its answers */
+static void *run_shard(void *arg)
+{
+    Shard *shard = arg;
+    for (int answer = shard->index; answer < WORDS; answer += shard->count) {
+        const char *answer_word = wordle_word(answer);
+        for (int guess = 0; guess < WORDS; ++guess) {
+            shard->mismatches += check_pair(wordle_word(guess), answer_word, true);
+            if ((guess + answer) % GAME_SAMPLE_PERIOD == 0) shard->mismatches += check_game(guess, answer);
+        }
+        shard->checked += WORDS;
+    }
+
+    unsigned long long state = shard->seed * 0x9E3779B97F4A7C15ull + shard->index + 1;
+    for (unsigned long long i = 0; i < shard->random; ++i) {
+        char guess[WORD_LEN];
+        char answer[WORD_LEN];
+        random_word(&state, guess);
+        random_word(&state, answer);
+        shard->mismatches += check_pair(guess, answer, true);
+    }
+    shard->checked += shard->random;
+    return NULL;
+}
+
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+int main(int argc, char **argv)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = cpus > 0 ? (int) cpus : 1;
+    unsigned long long random = DEFAULT_RANDOM;
+    unsigned long long seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--random") == 0 && i + 1 < argc) {
+            random = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "Usage: %s [--threads N] [--random N] [--seed N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (threads < 1 || threads > MAX_THREADS) {
+        fprintf(stderr, "ERROR: --threads must be between 1 and %d\n", MAX_THREADS);
+        return 1;
+    }
+
+    static Shard shards[MAX_THREADS];
+    double start = now_seconds();
+    for (int i = 0; i < threads; ++i) {
+        shards[i] = (Shard) {
+            .index = i,
+            .count = threads,
+            .seed = seed,
+            .random = random / threads + (i < (int) (random % threads) ? 1 : 0),
+        };
+        if (pthread_create(&shards[i].thread, NULL, run_shard, &shards[i]) != 0) {
+            fprintf(stderr, "ERROR: could not start thread %d\n", i);
+            return 1;
+        }
+    }
+
+    unsigned long long checked = 0;
+    unsigned long long mismatches = 0;
+    for (int i = 0; i < threads; ++i) {
+        pthread_join(shards[i].thread, NULL);
+        checked += shards[i].checked;
+        mismatches += shards[i].mismatches;
+    }
+
+    printf("checked %llu pairs on %d threads in %.2fs, %llu mismatches\n", checked, threads, now_seconds() - start, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
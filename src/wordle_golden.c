@@ -0,0 +1,224 @@
+/* Draws scripted states of the game with the software render backend and
+ * compares the frames with the golden images in assets/golden, so changes to
+ * the layout and the drawing code are checked without a display.
+ *
+ * Usage:
+ *   ./nob golden [--update] [--max-diff PERCENT] [NAME...]
+ *   ./build/wordle-golden [--update] [--max-diff PERCENT] [NAME...]
+ *
+ * A pixel differs when one of its channels is off by more than
+ * GOLDEN_TOLERANCE, and a state fails when more than --max-diff percent of
+ * its pixels differ. The frame of a failed state and a mask of the differing
+ * pixels are written to build/golden. --update writes the frames over the
+ * golden images instead, review them before committing. NAME runs only the
+ * states with that name.
+ */
+#define PLATFORM_HEADLESS
+#define RENDER_BACKEND_SOFTWARE
+#include "wordle.c"
+
+#define GOLDEN_DIR         "./assets/golden"
+#define GOLDEN_OUTPUT_DIR  "./build/golden"
+#define GOLDEN_ANSWER      "QUAIS"
+#define GOLDEN_TOLERANCE   8        // Largest difference of a channel that still counts as equal
+#define GOLDEN_MAX_DIFF    0.1      // Percent of pixels that may differ by default
+
+typedef struct Golden_State {
+    const char *name;
+    void (*setup)(void);
+} Golden_State;
+
+
+static void type_word(const char *word)
+{
+    for (int i = 0; word[i] != '\0'; ++i) add_guess_letter(word[i]);
+}
+
+
+static void guess_word(const char *word)
+{
+    type_word(word);
+    submit_guess();
+    skip_animations();
+}
+
+
+static void setup_start(void)
+{
+}
+
+
+static void setup_typing(void)
+{
+    guess_word("CRANE");
+    guess_word("SLOTH");
+    guess_word("PUDGY");
+    type_word("QUA");
+}
+
+
+static void setup_outcomes(void)
+{
+    guess_word("CRANE");
+    type_word("QUOTA");
+}
+
+
+static void setup_win(void)
+{
+    guess_word("CRANE");
+    guess_word("QUAIS");
+}
+
+
+static void setup_lose(void)
+{
+    const char *guesses[] = { "CRANE", "SLOTH", "PUDGY", "WIMPY", "FJORD", "BLOCK" };
+    for (size_t i = 0; i < ARRAY_LEN(guesses); ++i) guess_word(guesses[i]);
+}
+
+
+static void setup_stats(void)
+{
+    Stats_Record records[] = { {0, 0, 3, 1}, {0, 0, 4, 1}, {0, 0, 6, 0}, {0, 0, 4, 1}, {0, 0, 2, 1} };
+    for (size_t i = 0; i < ARRAY_LEN(records); ++i) stats_add(&stats, records[i]);
+    stats_last_attempts = 2;
+    stats_visible = true;
+}
+
+
+static Golden_State golden_states[] = {
+    { "start",    setup_start },
+    { "typing",   setup_typing },
+    { "outcomes", setup_outcomes },
+    { "win",      setup_win },
+    { "lose",     setup_lose },
+    { "stats",    setup_stats },
+};
+
+
+static bool is_selected(const char *name, int argc, char **names)
+{
+    if (argc == 0) return true;
+    for (int i = 0; i < argc; ++i) {
+        if (strcmp(names[i], name) == 0) return true;
+    }
+    return false;
+}
+
+
+/* Counts the differing pixels and marks them red in the mask */
+static int compare_images(Image actual, Image golden, Image *mask)
+{
+    const Color *a = actual.data;
+    const Color *b = golden.data;
+    *mask = GenImageColor(actual.width, actual.height, BLACK);
+    Color *m = mask->data;
+    int differing = 0;
+    for (int i = 0; i < actual.width * actual.height; ++i) {
+        int dr = abs(a[i].r - b[i].r);
+        int dg = abs(a[i].g - b[i].g);
+        int db = abs(a[i].b - b[i].b);
+        int da = abs(a[i].a - b[i].a);
+        if (dr > GOLDEN_TOLERANCE || dg > GOLDEN_TOLERANCE || db > GOLDEN_TOLERANCE || da > GOLDEN_TOLERANCE) {
+            m[i] = RED;
+            differing += 1;
+        }
+    }
+    return differing;
+}
+
+
+int main(int argc, char **argv)
+{
+    bool update_goldens = false;
+    double max_diff = GOLDEN_MAX_DIFF;
+    char **names = malloc(argc * sizeof(*names));
+    int names_count = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--update") == 0) {
+            update_goldens = true;
+        } else if (strcmp(argv[i], "--max-diff") == 0 && i + 1 < argc) {
+            max_diff = atof(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "Usage: %s [--update] [--max-diff PERCENT] [NAME...]\n", argv[0]);
+            return 1;
+        } else {
+            names[names_count++] = argv[i];
+        }
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+    Font letter_font = render_software_load_font(LETTER_FONT_FILEPATH, LETTER_FONT_SIZE);
+    if (letter_font.glyphs == NULL) {
+        fprintf(stderr, "ERROR: could not load %s\n", LETTER_FONT_FILEPATH);
+        return 1;
+    }
+    render_set_font(letter_font);
+    mkdir(GOLDEN_DIR, 0755);
+    mkdir("./build", 0755);
+    mkdir(GOLDEN_OUTPUT_DIR, 0755);
+
+    int failed = 0;
+    for (size_t i = 0; i < ARRAY_LEN(golden_states); ++i) {
+        const Golden_State *state = &golden_states[i];
+        if (!is_selected(state->name, names_count, names)) continue;
+
+        srand(0);
+        stats_init(&stats);
+        init_game();
+        wordle_new_game(&game.rules, wordle_find_word(GOLDEN_ANSWER));
+        state->setup();
+        update(1.0f); // Lets the letters and keys settle, the frame shows the state at rest
+        input = (Input) {
+            .screen_width = SCREEN_WIDTH,
+            .screen_height = SCREEN_HEIGHT,
+        };
+
+        Image frame = GenImageColor(SCREEN_WIDTH, SCREEN_HEIGHT, BLANK);
+        render_software_set_target(&frame);
+        draw_frame();
+
+        char golden_path[256];
+        snprintf(golden_path, sizeof(golden_path), "%s/%s.png", GOLDEN_DIR, state->name);
+        if (update_goldens) {
+            if (!ExportImage(frame, golden_path)) {
+                fprintf(stderr, "ERROR: could not write %s\n", golden_path);
+                failed += 1;
+            } else {
+                printf("%-10s updated %s\n", state->name, golden_path);
+            }
+            UnloadImage(frame);
+            continue;
+        }
+
+        Image golden = LoadImage(golden_path);
+        if (golden.data == NULL || golden.width != frame.width || golden.height != frame.height) {
+            printf("%-10s FAILED: %s is missing or %dx%d instead of %dx%d\n", state->name, golden_path, golden.width, golden.height, frame.width, frame.height);
+            failed += 1;
+        } else {
+            ImageFormat(&golden, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+            Image mask;
+            int differing = compare_images(frame, golden, &mask);
+            double percent = 100.0 * differing / (frame.width * frame.height);
+            if (percent > max_diff) {
+                char path[256];
+                snprintf(path, sizeof(path), "%s/%s.png", GOLDEN_OUTPUT_DIR, state->name);
+                ExportImage(frame, path);
+                snprintf(path, sizeof(path), "%s/%s.diff.png", GOLDEN_OUTPUT_DIR, state->name);
+                ExportImage(mask, path);
+                printf("%-10s FAILED: %d pixels (%.3f%%) differ, see %s\n", state->name, differing, percent, path);
+                failed += 1;
+            } else {
+                printf("%-10s ok, %d pixels (%.3f%%) differ\n", state->name, differing, percent);
+            }
+            UnloadImage(mask);
+        }
+        UnloadImage(golden);
+        UnloadImage(frame);
+    }
+
+    render_software_unload_font(letter_font);
+    free(names);
+    return failed == 0 ? 0 : 1;
+}
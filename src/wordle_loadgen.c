@@ -0,0 +1,651 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+#include "libwordle.h"
+
+// Load generator for wordle-server.
+//
+//     wordle-loadgen [--port N] [--connections N] [--duration SECONDS]
+//                    [--think MILLISECONDS] [--think-dist lognormal|exp|none]
+//                    [--seed N]
+//
+// Every connection plays complete games one request at a time: it creates a
+// game, guesses random words from the list until the game is over, deletes
+// it, and starts again. A connection that breaks is reopened and deletes
+// the game it was playing first. Before each guess the client waits for a random
+// think time with the given mean. Once the server reveals the answer every
+// feedback it sent for the game is checked against wordle_score, along with
+// the status and the number of attempts.
+//
+// Latency is measured from sending a request to receiving the whole response
+// and reported as percentiles of a log-linear histogram.
+
+#define DEFAULT_PORT        6970
+#define DEFAULT_CONNECTIONS 1000
+#define DEFAULT_DURATION    10.0
+#define DEFAULT_THINK_MS    20.0
+#define LOGNORMAL_SIGMA     1.0
+#define MAX_EVENTS          256
+#define BUFFER_SIZE         4096
+
+/* Histogram with HISTOGRAM_SUB_BUCKETS linear buckets per power of two, the
+ * relative error of a percentile is below 1/HISTOGRAM_SUB_BUCKETS */
+#define HISTOGRAM_SUB_BITS      5
+#define HISTOGRAM_SUB_BUCKETS   (1 << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_BUCKETS       (64*HISTOGRAM_SUB_BUCKETS)
+
+typedef enum Think_Dist {
+    THINK_NONE,
+    THINK_EXPONENTIAL,
+    THINK_LOGNORMAL,
+} Think_Dist;
+
+typedef enum Client_State {
+    CLIENT_CONNECTING,
+    CLIENT_THINKING,                // Waiting in the timer heap
+    CLIENT_WAITING,                 // Request sent, response not complete yet
+} Client_State;
+
+typedef enum Request_Kind {
+    REQUEST_CREATE,
+    REQUEST_GUESS,
+    REQUEST_DELETE,
+    REQUEST_CLEANUP,                // DELETE of the game a broken connection left behind
+} Request_Kind;
+
+typedef struct Client {
+    int fd;
+    Client_State state;
+    Request_Kind request;
+    long long sent_at;              // Nanoseconds
+    char out[BUFFER_SIZE];
+    size_t out_len;
+    size_t out_sent;
+    char in[BUFFER_SIZE];
+    size_t in_len;
+
+    unsigned long long game_id;
+    bool game_open;                 // The server holds game_id until a DELETE is answered
+    int attempt;
+    char guesses[WORDLE_MAX_ATTEMPTS][WORD_LEN];
+    char feedback[WORDLE_MAX_ATTEMPTS][WORD_LEN]; // As sent by the server
+} Client;
+
+typedef struct Timer {
+    long long deadline;             // Nanoseconds
+    int client;
+} Timer;
+
+/* Binary min-heap on deadline */
+typedef struct Timers {
+    Timer *items;
+    int count;
+    int capacity;
+} Timers;
+
+typedef struct Histogram {
+    unsigned long long counts[HISTOGRAM_BUCKETS];
+    unsigned long long total;
+    long long max;
+} Histogram;
+
+typedef struct Stats {
+    unsigned long long requests;
+    unsigned long long games;
+    unsigned long long errors;      // Unexpected HTTP status or unparsable response
+    unsigned long long mismatches;  // Responses disagreeing with wordle_score
+    unsigned long long connect_failures;
+} Stats;
+
+static Client *clients = NULL;
+static Timers timers = {0};
+static Histogram histogram = {0};
+static Stats stats = {0};
+static int epoll_fd = -1;
+static struct sockaddr_in server_addr = {0};
+static Think_Dist think_dist = THINK_LOGNORMAL;
+static double think_mean_ns = DEFAULT_THINK_MS*1e6;
+static unsigned long long rng_state = 0x9E3779B97F4A7C15ull;
+
+static const char feedback_chars[] = {
+    [WORDLE_FEEDBACK_WRONG]     = '.',
+    [WORDLE_FEEDBACK_MISPLACED] = 'Y',
+    [WORDLE_FEEDBACK_CORRECT]   = 'G',
+};
+
+
+long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec*1000000000ll + ts.tv_nsec;
+}
+
+
+unsigned long long random_u64(void)
+{
+    /* xorshift64* */
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1Dull;
+}
+
+
+/* Uniform in (0, 1] */
+double random_unit(void)
+{
+    return ((random_u64() >> 11) + 1) * (1.0/9007199254740992.0);
+}
+
+
+long long think_time_ns(void)
+{
+    switch (think_dist) {
+        case THINK_NONE: return 0;
+        case THINK_EXPONENTIAL: return -log(random_unit())*think_mean_ns;
+        case THINK_LOGNORMAL: {
+            /* Box-Muller, mu is chosen so that the mean is think_mean_ns */
+            double normal = sqrt(-2.0*log(random_unit()))*cos(2.0*M_PI*random_unit());
+            double mu = log(think_mean_ns) - LOGNORMAL_SIGMA*LOGNORMAL_SIGMA/2.0;
+            return exp(mu + LOGNORMAL_SIGMA*normal);
+        }
+    }
+    return 0;
+}
+
+
+/* Histogram */
+
+int histogram_bucket(long long value)
+{
+    if (value < HISTOGRAM_SUB_BUCKETS) return value < 0 ? 0 : value;
+    int exponent = 63 - __builtin_clzll(value);
+    int shift = exponent - HISTOGRAM_SUB_BITS;
+    int sub = (value >> shift) & (HISTOGRAM_SUB_BUCKETS - 1);
+    return (shift + 1)*HISTOGRAM_SUB_BUCKETS + sub;
+}
+
+
+/* Upper bound of the values that fall into the bucket */
+long long histogram_bucket_value(int bucket)
+{
+    if (bucket < HISTOGRAM_SUB_BUCKETS) return bucket;
+    int shift = bucket/HISTOGRAM_SUB_BUCKETS - 1;
+    long long sub = bucket % HISTOGRAM_SUB_BUCKETS;
+    return ((HISTOGRAM_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+
+void histogram_record(Histogram *h, long long value)
+{
+    h->counts[histogram_bucket(value)] += 1;
+    h->total += 1;
+    if (value > h->max) h->max = value;
+}
+
+
+long long histogram_percentile(const Histogram *h, double percentile)
+{
+    unsigned long long rank = (unsigned long long) ceil(h->total*percentile/100.0);
+    if (rank == 0) rank = 1;
+    unsigned long long seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            long long value = histogram_bucket_value(i);
+            return value < h->max ? value : h->max;
+        }
+    }
+    return h->max;
+}
+
+
+/* Timer heap */
+
+void timers_push(long long deadline, int client)
+{
+    if (timers.count == timers.capacity) {
+        timers.capacity = timers.capacity == 0 ? 1024 : timers.capacity*2;
+        timers.items = realloc(timers.items, timers.capacity*sizeof(*timers.items));
+        if (timers.items == NULL) {
+            fprintf(stderr, "ERROR: out of memory\n");
+            exit(1);
+        }
+    }
+    int i = timers.count++;
+    while (i > 0) {
+        int parent = (i - 1)/2;
+        if (timers.items[parent].deadline <= deadline) break;
+        timers.items[i] = timers.items[parent];
+        i = parent;
+    }
+    timers.items[i].deadline = deadline;
+    timers.items[i].client = client;
+}
+
+
+Timer timers_pop(void)
+{
+    Timer top = timers.items[0];
+    Timer last = timers.items[--timers.count];
+    int i = 0;
+    for (;;) {
+        int child = 2*i + 1;
+        if (child >= timers.count) break;
+        if (child + 1 < timers.count && timers.items[child + 1].deadline < timers.items[child].deadline) child += 1;
+        if (last.deadline <= timers.items[child].deadline) break;
+        timers.items[i] = timers.items[child];
+        i = child;
+    }
+    timers.items[i] = last;
+    return top;
+}
+
+
+/* Response parsing */
+
+/* Returns the size of the complete response at the front of the buffer, or 0
+ * if more bytes are needed */
+size_t parse_response(const char *buffer, size_t len, int *status, const char **body, size_t *body_len)
+{
+    const char *end = buffer + len;
+    const char *headers_end = NULL;
+    for (const char *p = buffer; p + 3 < end; ++p) {
+        if (p[0] == '\r' && p[1] == '\n' && p[2] == '\r' && p[3] == '\n') {
+            headers_end = p + 4;
+            break;
+        }
+    }
+    if (headers_end == NULL) return 0;
+
+    *status = 0;
+    const char *p = memchr(buffer, ' ', headers_end - buffer);
+    if (p != NULL) *status = atoi(p + 1);
+
+    size_t content_length = 0;
+    const char *header = "\r\nContent-Length:";
+    for (p = buffer; p + strlen(header) < headers_end; ++p) {
+        if (strncasecmp(p, header, strlen(header)) == 0) {
+            content_length = strtoul(p + strlen(header), NULL, 10);
+            break;
+        }
+    }
+    if ((size_t)(end - headers_end) < content_length) return 0;
+
+    *body = headers_end;
+    *body_len = content_length;
+    return (headers_end - buffer) + content_length;
+}
+
+
+/* Finds the value of the last occurrence of "key": in the body */
+const char *json_find(const char *body, size_t body_len, const char *key)
+{
+    size_t key_len = strlen(key);
+    const char *found = NULL;
+    for (const char *p = body; p + key_len + 3 <= body + body_len; ++p) {
+        if (p[0] == '"' && memcmp(p + 1, key, key_len) == 0 && p[key_len + 1] == '"' && p[key_len + 2] == ':') {
+            found = p + key_len + 3;
+        }
+    }
+    return found;
+}
+
+
+/* Game */
+
+void watch_client(Client *client, unsigned int events)
+{
+    struct epoll_event event = {0};
+    event.events = events;
+    event.data.u32 = client - clients;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, client->fd, &event);
+}
+
+
+void send_request(Client *client, Request_Kind kind, const char *method, const char *path, const char *body)
+{
+    size_t body_len = body ? strlen(body) : 0;
+    int len = snprintf(client->out, BUFFER_SIZE,
+        "%s %s HTTP/1.1\r\n"
+        "Host: 127.0.0.1\r\n"
+        "Content-Length: %zu\r\n"
+        "\r\n"
+        "%s",
+        method, path, body_len, body ? body : "");
+    client->out_len = len;
+    client->out_sent = 0;
+    client->request = kind;
+    client->state = CLIENT_WAITING;
+    client->sent_at = now_ns();
+    watch_client(client, EPOLLIN | EPOLLOUT);
+}
+
+
+void send_create(Client *client)
+{
+    send_request(client, REQUEST_CREATE, "POST", "/games", NULL);
+}
+
+
+void send_guess(Client *client)
+{
+    const char *word = wordle_word(random_u64() % WORDS);
+    memcpy(client->guesses[client->attempt], word, WORD_LEN);
+
+    char path[64];
+    char body[32];
+    snprintf(path, sizeof(path), "/games/%llu/guesses", client->game_id);
+    snprintf(body, sizeof(body), "{\"guess\":\"%.*s\"}", WORD_LEN, word);
+    send_request(client, REQUEST_GUESS, "POST", path, body);
+}
+
+
+void send_delete(Client *client, Request_Kind kind)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/games/%llu", client->game_id);
+    send_request(client, kind, "DELETE", path, NULL);
+}
+
+
+void think(Client *client)
+{
+    client->state = CLIENT_THINKING;
+    watch_client(client, EPOLLIN);
+    timers_push(now_ns() + think_time_ns(), client - clients);
+}
+
+
+/* Checks everything the server said about the game against libwordle */
+bool verify_game(const Client *client, const char *answer, const char *status)
+{
+    bool won = false;
+    for (int i = 0; i < client->attempt; ++i) {
+        Wordle_Feedback feedback[WORD_LEN];
+        wordle_score(client->guesses[i], answer, feedback);
+        won = true;
+        for (int j = 0; j < WORD_LEN; ++j) {
+            if (client->feedback[i][j] != feedback_chars[feedback[j]]) return false;
+            won = won && feedback[j] == WORDLE_FEEDBACK_CORRECT;
+        }
+        if (won && i + 1 != client->attempt) return false;
+    }
+    if (won) return strncmp(status, "won\"", 4) == 0;
+    return client->attempt == WORDLE_MAX_ATTEMPTS && strncmp(status, "lost\"", 5) == 0;
+}
+
+
+/* Handles a complete response, returns false if the connection is unusable */
+bool handle_response(Client *client, int status, const char *body, size_t body_len)
+{
+    stats.requests += 1;
+    histogram_record(&histogram, now_ns() - client->sent_at);
+
+    switch (client->request) {
+        case REQUEST_CREATE: {
+            const char *id = json_find(body, body_len, "id");
+            if (status != 201 || id == NULL) {
+                stats.errors += 1;
+                return false;
+            }
+            client->game_id = strtoull(id, NULL, 10);
+            client->game_open = true;
+            client->attempt = 0;
+            think(client);
+        } break;
+
+        case REQUEST_GUESS: {
+            const char *feedback = json_find(body, body_len, "feedback");
+            const char *game_status = json_find(body, body_len, "status");
+            if (status != 200 || feedback == NULL || game_status == NULL || *feedback != '"') {
+                stats.errors += 1;
+                return false;
+            }
+            memcpy(client->feedback[client->attempt], feedback + 1, WORD_LEN);
+            client->attempt += 1;
+
+            if (strncmp(game_status, "\"playing\"", 9) == 0) {
+                if (client->attempt >= WORDLE_MAX_ATTEMPTS) stats.mismatches += 1;
+                think(client);
+                break;
+            }
+
+            const char *answer = json_find(body, body_len, "answer");
+            if (answer == NULL || !verify_game(client, answer + 1, game_status + 1)) stats.mismatches += 1;
+            stats.games += 1;
+            send_delete(client, REQUEST_DELETE);
+        } break;
+
+        case REQUEST_DELETE: {
+            if (status != 204) stats.errors += 1;
+            client->game_open = false;
+            send_create(client);
+        } break;
+
+        case REQUEST_CLEANUP: {
+            /* The broken connection may have deleted it already */
+            if (status != 204 && status != 404) stats.errors += 1;
+            client->game_open = false;
+            send_create(client);
+        } break;
+    }
+    return true;
+}
+
+
+void open_client(Client *client)
+{
+    client->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (client->fd < 0) {
+        fprintf(stderr, "ERROR: could not create socket: %s\n", strerror(errno));
+        exit(1);
+    }
+    int yes = 1;
+    setsockopt(client->fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+    client->state = CLIENT_CONNECTING;
+    client->in_len = 0;
+    client->out_len = 0;
+    client->out_sent = 0;
+    if (connect(client->fd, (struct sockaddr *) &server_addr, sizeof(server_addr)) < 0 && errno != EINPROGRESS) {
+        fprintf(stderr, "ERROR: could not connect: %s\n", strerror(errno));
+        exit(1);
+    }
+
+    struct epoll_event event = {0};
+    event.events = EPOLLOUT;
+    event.data.u32 = client - clients;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client->fd, &event);
+}
+
+
+/* An open game is deleted as soon as the new connection is up */
+void reopen_client(Client *client)
+{
+    close(client->fd);
+    open_client(client);
+}
+
+
+/* Returns false if the connection is unusable */
+bool serve_client(Client *client, unsigned int events)
+{
+    if (client->state == CLIENT_CONNECTING) {
+        int error = 0;
+        socklen_t len = sizeof(error);
+        getsockopt(client->fd, SOL_SOCKET, SO_ERROR, &error, &len);
+        if (error != 0) {
+            stats.connect_failures += 1;
+            return false;
+        }
+        if (client->game_open) send_delete(client, REQUEST_CLEANUP);
+        else send_create(client);
+        return true;
+    }
+
+    if ((events & EPOLLOUT) && client->out_sent < client->out_len) {
+        ssize_t n = send(client->fd, client->out + client->out_sent, client->out_len - client->out_sent, MSG_NOSIGNAL);
+        if (n < 0 && errno != EAGAIN && errno != EINTR) return false;
+        if (n > 0) client->out_sent += n;
+        /* A socket is writable nearly all the time, keeping EPOLLOUT would
+         * wake the loop for every client waiting on a response */
+        if (client->out_sent == client->out_len) watch_client(client, EPOLLIN);
+    }
+
+    if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        ssize_t n = recv(client->fd, client->in + client->in_len, BUFFER_SIZE - client->in_len, 0);
+        if (n == 0) return false;
+        if (n < 0) return errno == EAGAIN || errno == EINTR;
+        client->in_len += n;
+
+        int status;
+        const char *body;
+        size_t body_len;
+        size_t size = parse_response(client->in, client->in_len, &status, &body, &body_len);
+        if (size == 0) return client->in_len < BUFFER_SIZE;
+        if (client->state != CLIENT_WAITING) return false;
+        bool ok = handle_response(client, status, body, body_len);
+        client->in_len -= size;
+        memmove(client->in, client->in + size, client->in_len);
+        return ok;
+    }
+    return true;
+}
+
+
+void raise_fd_limit(int connections)
+{
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) < 0) return;
+    if (limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    if (limit.rlim_cur < (rlim_t) connections + 16) {
+        fprintf(stderr, "WARNING: open file limit %llu is too low for %d connections\n",
+                (unsigned long long) limit.rlim_cur, connections);
+    }
+}
+
+
+void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--port N] [--connections N] [--duration SECONDS]\n", program);
+    fprintf(stderr, "       %*s [--think MILLISECONDS] [--think-dist lognormal|exp|none] [--seed N]\n", (int) strlen(program), "");
+}
+
+
+int main(int argc, char **argv)
+{
+    int port = DEFAULT_PORT;
+    int connections = DEFAULT_CONNECTIONS;
+    double duration = DEFAULT_DURATION;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--connections") == 0 && i + 1 < argc) {
+            connections = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            duration = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--think") == 0 && i + 1 < argc) {
+            think_mean_ns = atof(argv[++i])*1e6;
+        } else if (strcmp(argv[i], "--think-dist") == 0 && i + 1 < argc) {
+            const char *dist = argv[++i];
+            if (strcmp(dist, "lognormal") == 0) think_dist = THINK_LOGNORMAL;
+            else if (strcmp(dist, "exp") == 0) think_dist = THINK_EXPONENTIAL;
+            else if (strcmp(dist, "none") == 0) think_dist = THINK_NONE;
+            else {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            rng_state = strtoull(argv[++i], NULL, 10) | 1;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (connections <= 0 || duration <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (think_mean_ns <= 0) think_dist = THINK_NONE;
+
+    signal(SIGPIPE, SIG_IGN);
+    raise_fd_limit(connections);
+
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(port);
+    server_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    epoll_fd = epoll_create1(0);
+    clients = calloc(connections, sizeof(*clients));
+    if (epoll_fd < 0 || clients == NULL) {
+        fprintf(stderr, "ERROR: could not set up: %s\n", strerror(errno));
+        return 1;
+    }
+    for (int i = 0; i < connections; ++i) open_client(&clients[i]);
+
+    long long start = now_ns();
+    long long end = start + (long long)(duration*1e9);
+    struct epoll_event events[MAX_EVENTS];
+    for (;;) {
+        long long now = now_ns();
+        if (now >= end) break;
+
+        /* Timers of clients reconnected while thinking are stale and skipped */
+        while (timers.count > 0 && timers.items[0].deadline <= now) {
+            Client *client = &clients[timers_pop().client];
+            if (client->state == CLIENT_THINKING) send_guess(client);
+        }
+
+        long long wake = end;
+        if (timers.count > 0 && timers.items[0].deadline < wake) wake = timers.items[0].deadline;
+        int timeout_ms = (wake - now + 999999)/1000000;
+
+        int count = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout_ms);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "ERROR: epoll_wait failed: %s\n", strerror(errno));
+            return 1;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            Client *client = &clients[events[i].data.u32];
+            if (!serve_client(client, events[i].events)) {
+                stats.errors += 1;
+                reopen_client(client);
+            }
+        }
+    }
+    double elapsed = (now_ns() - start)/1e9;
+
+    printf("connections: %d\n", connections);
+    printf("duration:    %.2f s\n", elapsed);
+    printf("requests:    %llu (%.0f req/s)\n", stats.requests, stats.requests/elapsed);
+    printf("games:       %llu (%.0f games/s)\n", stats.games, stats.games/elapsed);
+    printf("latency:     p50 %.1f us, p99 %.1f us, p999 %.1f us, max %.1f us\n",
+           histogram_percentile(&histogram, 50.0)/1e3,
+           histogram_percentile(&histogram, 99.0)/1e3,
+           histogram_percentile(&histogram, 99.9)/1e3,
+           histogram.max/1e3);
+    printf("errors:      %llu\n", stats.errors + stats.connect_failures);
+    printf("mismatches:  %llu\n", stats.mismatches);
+    return stats.mismatches > 0 || stats.errors > 0 || stats.connect_failures > 0 ? 1 : 0;
+}
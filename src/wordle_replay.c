@@ -0,0 +1,173 @@
+/* Replays an input recording of the game without a window and as fast as
+ * the game logic runs. Every frame gets the recorded input and dt, so the
+ * session ends in exactly the state it ended in when it was recorded.
+ *
+ * Usage:
+ *   ./build/wordle --record session.rec
+ *   ./build/wordle-replay [--repeat N] [--no-draw] [--trace PATH] session.rec
+ *
+ * It prints how fast the frames ran and the state of the game at the end of
+ * the recording, which can be diffed between builds. --repeat runs the
+ * recording N times, to profile or train PGO builds on real sessions.
+ * --no-draw only updates the game, which ends in the same state. Built with
+ * ./nob --debug it also prints the sections of the in-game profiler.
+ * --trace writes the spans of the last frames as a Chrome trace.
+ */
+#define PLATFORM_HEADLESS
+#include "wordle.c"
+
+#include <time.h>
+
+
+typedef struct Frames {
+    Input *items;
+    size_t count;
+    size_t capacity;
+} Frames;
+
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static const char *state_name(State state)
+{
+    switch (state) {
+        case STATE_PLAY:                return "play";
+        case STATE_NON_EXISTENT_WORD:   return "non existent word";
+        case STATE_USER_GUESS_CORRECT:  return "guess correct";
+        case STATE_USER_GUESS_COLORING: return "guess coloring";
+        case STATE_USER_GUESS_APPEAR:   return "guess appear";
+        case STATE_WIN:                 return "win";
+        case STATE_LOSE:                return "lose";
+        case STATE_RESTART_FADEIN:      return "restart fade in";
+        case STATE_RESTART_FADEOUT:     return "restart fade out";
+    }
+    return "unknown";
+}
+
+
+static void print_game(void)
+{
+    printf("state: %s\n", state_name(game.state));
+    printf("answer: %.*s\n", WORD_LEN, wordle_answer(&game.rules));
+    for (int i = 0; i < game.rules.attempt; ++i) {
+        char guess[WORD_LEN];
+        Wordle_Feedback feedback[WORD_LEN];
+        wordle_game_guess(&game.rules, i, guess);
+        wordle_game_feedback(&game.rules, i, feedback);
+        char colors[WORD_LEN];
+        for (int j = 0; j < WORD_LEN; ++j) colors[j] = ".YG"[feedback[j]];
+        printf("guess %d: %.*s %.*s\n", i + 1, WORD_LEN, guess, WORD_LEN, colors);
+    }
+    char typed[WORD_LEN];
+    for (int i = 0; i < game.current_guess_len; ++i) typed[i] = game.current_guess[i].chr;
+    printf("typed: %.*s\n", game.current_guess_len, typed);
+    printf("games finished: %u, won: %u\n", stats.played, stats.won);
+}
+
+
+#ifdef PROFILER_ENABLED
+/* Sections of the last frames the profiler kept, built with --debug */
+static void print_profile(void)
+{
+    int count = profiler_frames_count();
+    if (count == 0) return;
+    printf("last %d frames:\n", count);
+    for (int j = 0; j < PROFILE_SECTIONS; ++j) {
+        double total = 0.0;
+        for (int i = 0; i < count; ++i) total += profiler_frame(i)->sections[j];
+        printf("    %-16s %8.0f ns\n", profile_section_names[j], total * 1e9 / count);
+    }
+}
+#endif // PROFILER_ENABLED
+
+
+int main(int argc, char **argv)
+{
+    const char *path = NULL;
+    int repeat = 1;
+    bool draw = true;
+    const char *trace_path = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+            if (repeat < 1) repeat = 1;
+        } else if (strcmp(argv[i], "--no-draw") == 0) {
+            draw = false;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == NULL) {
+        fprintf(stderr, "Usage: %s [--repeat N] [--no-draw] [--trace PATH] <recording>\n", argv[0]);
+        return 1;
+    }
+
+    /* Frames are read up front so the timing covers the game only */
+    Recording recording;
+    unsigned int seed;
+    if (!recording_open_for_read(&recording, path, &seed)) {
+        fprintf(stderr, "ERROR: %s is not a recording of this version of the game\n", path);
+        return 1;
+    }
+    Frames frames = {0};
+    double game_time = 0.0;
+    for (;;) {
+        if (frames.count == frames.capacity) {
+            frames.capacity = frames.capacity == 0 ? 1024 : frames.capacity * 2;
+            frames.items = realloc(frames.items, frames.capacity * sizeof(*frames.items));
+            if (frames.items == NULL) {
+                fprintf(stderr, "ERROR: out of memory\n");
+                return 1;
+            }
+        }
+        if (!recording_read_frame(&recording, &frames.items[frames.count])) break;
+        game_time += frames.items[frames.count].dt;
+        frames.count += 1;
+    }
+    recording_close(&recording);
+
+    double elapsed = 0.0;
+    for (int r = 0; r < repeat; ++r) {
+        srand(seed);
+        stats_init(&stats);
+        init_game();
+
+        double start = now_seconds();
+        for (size_t i = 0; i < frames.count; ++i) {
+            TRACE_BEGIN(game_frame);
+            input = frames.items[i];
+            PROFILE_FRAME_BEGIN(input.dt);
+            PROFILE_BEGIN(PROFILE_FRAME);
+            update_frame();
+            if (draw) draw_frame();
+            PROFILE_END(PROFILE_FRAME);
+            PROFILE_FRAME_END();
+            TRACE_END(game_frame);
+        }
+        elapsed += now_seconds() - start;
+    }
+
+    size_t total = frames.count * repeat;
+    printf("frames: %zu, game time: %.2fs\n", frames.count, game_time);
+    printf("replayed %zu frames in %.3fms, %.0f ns/frame\n", total, elapsed * 1e3, total > 0 ? elapsed * 1e9 / total : 0.0);
+    print_game();
+#ifdef PROFILER_ENABLED
+    print_profile();
+#endif
+
+    if (trace_path != NULL && !trace_dump(trace_path)) {
+        fprintf(stderr, "ERROR: could not write the trace to %s\n", trace_path);
+        return 1;
+    }
+
+    free(frames.items);
+    return 0;
+}
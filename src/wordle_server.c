@@ -0,0 +1,1451 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+
+#if defined(__has_include) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#ifdef IORING_RECV_MULTISHOT
+#define HAVE_IO_URING
+#include <poll.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+#include "libwordle.h"
+
+// HTTP/JSON server hosting many independent games on localhost.
+//
+//     wordle-server [--port N] [--threads N] [--sessions N] [--seed N]
+//                   [--idle-timeout SECONDS] [--backend epoll|io_uring]
+//
+// Routes:
+//     POST   /games               Start a game, responds with its state
+//     GET    /games/{id}          State of the game
+//     POST   /games/{id}/guesses  Submit {"guess": "CRANE"}, responds with the state
+//     DELETE /games/{id}          Forget the game
+//
+// State of a game:
+//     {"id": 4294967296, "status": "playing", "attempt": 1,
+//      "guesses": [{"word": "CRANE", "feedback": "..G.G"}]}
+// The answer is added as "answer" once the status is "won" or "lost". IDs
+// stay below 2^53, so JSON parsers that read numbers as doubles keep them
+// exact.
+// Feedback uses the characters of wordle-cli: G right place, Y wrong place,
+// . absent.
+//
+// The server is split into shards, one thread per core by default. Every
+// shard runs its own epoll loop over non-blocking sockets and owns its games
+// and buffers outright, so nothing is locked on the request path. The
+// shards listen on the same port with SO_REUSEPORT and the kernel spreads
+// new connections between them. Connections are kept alive and may pipeline
+// requests.
+//
+// Games are allocated from a fixed pool per shard. The ID of a game holds
+// the slot index in the low SESSION_INDEX_BITS, the shard above it and the
+// generation of the slot in the SESSION_GENERATION_BITS above that. The
+// generation wraps, so the ID of a deleted game is reused only after its
+// slot is freed 2^SESSION_GENERATION_BITS times. A request for a game of
+// another shard hands the connection over to that shard together with the
+// unanswered input, and the owner carries on serving it.
+//
+// Clients that leave without a DELETE would keep their games forever, so a
+// game that is not requested for --idle-timeout seconds expires. Expired
+// games are reclaimed by a clock hand over the pool that advances
+// SESSION_SWEEP_STEP slots on every new game, and goes round the whole pool
+// before a new game is refused.
+//
+// Shards wait for sockets with epoll by default. With --backend io_uring
+// they use a ring per shard instead: a multishot accept, a multishot recv
+// per connection filling buffers from a ring provided to the kernel, and
+// sends, all submitted with one io_uring_enter per batch of completions.
+// The io_uring backend is compiled in when the kernel headers define
+// multishot recv (Linux 6.0) and needs a kernel that supports it.
+
+#define DEFAULT_PORT        6970
+#define DEFAULT_SESSIONS    (1 << 16) // Per shard
+#define SESSION_INDEX_BITS  24
+#define SESSION_SHARD_BITS  8
+#define SESSION_GENERATION_SHIFT (SESSION_INDEX_BITS + SESSION_SHARD_BITS)
+#define SESSION_GENERATION_BITS  (53 - SESSION_GENERATION_SHIFT) // IDs stay below 2^53
+#define DEFAULT_IDLE_TIMEOUT (30*60) // Seconds
+#define SESSION_SWEEP_STEP  4
+#define MAX_SESSIONS        (1 << SESSION_INDEX_BITS)
+#define MAX_SHARDS          (1 << SESSION_SHARD_BITS)
+#define MAX_CONNECTIONS     (1 << 14) // Per shard
+#define MAX_EVENTS          256
+#define CONN_BUFFER_SIZE    (8*1024)
+#define MAX_RESPONSE_SIZE   1024
+
+typedef struct Session {
+    Wordle_Game game;
+    unsigned int generation;        // Bumped every time the slot is freed
+    int next_free;                  // Next slot in the free list, -1 at the end
+    long long last_used;            // Seconds on the monotonic clock
+    bool used;
+} Session;
+
+typedef struct Sessions {
+    Session *items;
+    int capacity;
+    int free;                       // First free slot, -1 if the pool is exhausted
+    int hand;                       // Next slot checked for expiry
+} Sessions;
+
+typedef struct Conn {
+    int fd;
+    char in[CONN_BUFFER_SIZE];
+    size_t in_len;
+    char out[CONN_BUFFER_SIZE];
+    size_t out_len;
+    size_t out_sent;
+    bool close_after_write;         // Client asked for Connection: close or sent a bad request
+    int handoff_to;                 // Shard owning the game of the next request, -1 if it is this one
+    int next_free;
+
+    /* io_uring backend only */
+    bool recv_armed;                // Multishot recv is in the ring
+    bool send_in_flight;
+    bool closing;                   // Close once no operation is left in the ring
+    bool handing_off;               // Hand off once no operation is left in the ring
+} Conn;
+
+typedef struct Conns {
+    Conn *items;
+    int free;
+    int used;                       // Slots ever handed out, the pages of the rest are never touched
+} Conns;
+
+typedef struct Request {
+    const char *method;
+    size_t method_len;
+    const char *path;
+    size_t path_len;
+    const char *body;
+    size_t body_len;
+    bool keep_alive;
+} Request;
+
+typedef struct Response {
+    int status;
+    char body[MAX_RESPONSE_SIZE];
+    size_t body_len;
+} Response;
+
+/* Connection moving to another shard, passed by pointer through a pipe */
+typedef struct Handoff {
+    int fd;
+    size_t in_len;
+    char in[CONN_BUFFER_SIZE];
+} Handoff;
+
+typedef enum Backend {
+    BACKEND_EPOLL,
+    BACKEND_IO_URING,
+} Backend;
+
+#ifdef HAVE_IO_URING
+#define URING_ENTRIES       4096
+#define URING_BUFFERS       1024    // Power of two
+#define URING_BUFFER_SIZE   4096
+#define URING_BUFFER_GROUP  0
+
+typedef struct Ring {
+    int fd;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe *cqes;
+    unsigned to_submit;
+    struct io_uring_buf_ring *buf_ring;  // Buffers the kernel picks from for recv
+    char *buffers;
+    void *rings;
+    size_t rings_size;
+    size_t sqes_size;
+} Ring;
+#endif
+
+typedef struct Shard {
+    int index;
+    int listen_fd;
+    int epoll_fd;
+    int handoff_pipe[2];            // Other shards write Handoff pointers to [1]
+    Sessions sessions;
+    Conns conns;
+    Response response;
+    unsigned long long rng_state;
+    pthread_t thread;
+#ifdef HAVE_IO_URING
+    Ring ring;
+#endif
+} Shard;
+
+typedef enum Conn_Action {
+    CONN_KEEP,
+    CONN_CLOSE,
+    CONN_HANDOFF,                   // Move the connection to conn->handoff_to
+} Conn_Action;
+
+static Shard *shards = NULL;
+static int shard_count = 0;
+static int sessions_per_shard = DEFAULT_SESSIONS;
+static long long idle_timeout = DEFAULT_IDLE_TIMEOUT;
+static Backend backend = BACKEND_EPOLL;
+
+/* Distinct addresses telling the non-connection epoll entries apart */
+static char listener_tag;
+static char handoff_tag;
+
+static const char feedback_chars[] = {
+    [WORDLE_FEEDBACK_WRONG]     = '.',
+    [WORDLE_FEEDBACK_MISPLACED] = 'Y',
+    [WORDLE_FEEDBACK_CORRECT]   = 'G',
+};
+
+
+int random_answer(Shard *shard)
+{
+    /* xorshift64* */
+    shard->rng_state ^= shard->rng_state >> 12;
+    shard->rng_state ^= shard->rng_state << 25;
+    shard->rng_state ^= shard->rng_state >> 27;
+    return (shard->rng_state * 0x2545F4914F6CDD1Dull >> 32) % WORDS;
+}
+
+
+void *alloc_or_die(size_t count, size_t size)
+{
+    void *items = calloc(count, size);
+    if (items == NULL) {
+        fprintf(stderr, "ERROR: out of memory\n");
+        exit(1);
+    }
+    return items;
+}
+
+
+void init_sessions(Sessions *sessions, int capacity)
+{
+    sessions->items = alloc_or_die(capacity, sizeof(*sessions->items));
+    sessions->capacity = capacity;
+    for (int i = 0; i < capacity; ++i) {
+        sessions->items[i].next_free = i + 1 < capacity ? i + 1 : -1;
+    }
+    sessions->free = 0;
+    sessions->hand = 0;
+}
+
+
+int session_shard(unsigned long long id)
+{
+    return (id >> SESSION_INDEX_BITS) & (MAX_SHARDS - 1);
+}
+
+
+void free_session(Shard *shard, Session *session)
+{
+    Sessions *sessions = &shard->sessions;
+    session->used = false;
+    session->generation = (session->generation + 1) & ((1u << SESSION_GENERATION_BITS) - 1);
+    session->next_free = sessions->free;
+    sessions->free = session - sessions->items;
+}
+
+
+long long now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return ts.tv_sec;
+}
+
+
+/* Frees the expired games among the next count slots under the hand */
+void sweep_sessions(Shard *shard, int count, long long now)
+{
+    Sessions *sessions = &shard->sessions;
+    for (int i = 0; i < count; ++i) {
+        Session *session = &sessions->items[sessions->hand];
+        sessions->hand = (sessions->hand + 1) % sessions->capacity;
+        if (session->used && now - session->last_used >= idle_timeout) free_session(shard, session);
+    }
+}
+
+
+Session *alloc_session(Shard *shard, unsigned long long *id)
+{
+    Sessions *sessions = &shard->sessions;
+    long long now = now_seconds();
+    sweep_sessions(shard, SESSION_SWEEP_STEP, now);
+    if (sessions->free < 0) sweep_sessions(shard, sessions->capacity, now);
+    if (sessions->free < 0) return NULL;
+    int index = sessions->free;
+    Session *session = &sessions->items[index];
+    sessions->free = session->next_free;
+    session->used = true;
+    session->last_used = now;
+    *id = ((unsigned long long) session->generation << SESSION_GENERATION_SHIFT)
+        | ((unsigned long long) shard->index << SESSION_INDEX_BITS)
+        | (unsigned int) index;
+    return session;
+}
+
+
+Session *find_session(Shard *shard, unsigned long long id)
+{
+    Sessions *sessions = &shard->sessions;
+    unsigned int index = id & (MAX_SESSIONS - 1);
+    if (session_shard(id) != shard->index || index >= (unsigned int) sessions->capacity) return NULL;
+    Session *session = &sessions->items[index];
+    if (!session->used || session->generation != (id >> SESSION_GENERATION_SHIFT)) return NULL;
+    long long now = now_seconds();
+    if (now - session->last_used >= idle_timeout) {
+        /* Expired before the hand came round */
+        free_session(shard, session);
+        return NULL;
+    }
+    session->last_used = now;
+    return session;
+}
+
+
+/* The pool is only reserved here. Slots are taken in order as the number of
+ * open connections grows, and the free list holds the released ones, so a
+ * shard stays small until it has as many clients. */
+void init_conns(Conns *conns)
+{
+    conns->items = alloc_or_die(MAX_CONNECTIONS, sizeof(*conns->items));
+    conns->free = -1;
+    conns->used = 0;
+}
+
+
+Conn *alloc_conn(Shard *shard, int fd)
+{
+    Conns *conns = &shard->conns;
+    Conn *conn;
+    if (conns->free >= 0) {
+        conn = &conns->items[conns->free];
+        conns->free = conn->next_free;
+    } else if (conns->used < MAX_CONNECTIONS) {
+        conn = &conns->items[conns->used++];
+    } else {
+        return NULL;
+    }
+    conn->fd = fd;
+    conn->in_len = 0;
+    conn->out_len = 0;
+    conn->out_sent = 0;
+    conn->close_after_write = false;
+    conn->handoff_to = -1;
+    conn->recv_armed = false;
+    conn->send_in_flight = false;
+    conn->closing = false;
+    conn->handing_off = false;
+    return conn;
+}
+
+
+/* Returns the connection to the pool without closing the socket */
+void release_conn(Shard *shard, Conn *conn)
+{
+    Conns *conns = &shard->conns;
+    conn->fd = -1;
+    conn->next_free = conns->free;
+    conns->free = conn - conns->items;
+}
+
+
+void free_conn(Shard *shard, Conn *conn)
+{
+    close(conn->fd);
+    release_conn(shard, conn);
+}
+
+
+/* JSON */
+
+void append_cstr(Response *response, const char *cstr)
+{
+    size_t len = strlen(cstr);
+    if (response->body_len + len > MAX_RESPONSE_SIZE) return;
+    memcpy(response->body + response->body_len, cstr, len);
+    response->body_len += len;
+}
+
+
+void append_buf(Response *response, const char *buf, size_t len)
+{
+    if (response->body_len + len > MAX_RESPONSE_SIZE) return;
+    memcpy(response->body + response->body_len, buf, len);
+    response->body_len += len;
+}
+
+
+void append_u64(Response *response, unsigned long long value)
+{
+    char digits[24];
+    int len = 0;
+    do {
+        digits[sizeof(digits) - 1 - len++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    append_buf(response, digits + sizeof(digits) - len, len);
+}
+
+
+const char *status_name(Wordle_Status status)
+{
+    switch (status) {
+        case WORDLE_STATUS_PLAYING: return "playing";
+        case WORDLE_STATUS_WON:     return "won";
+        case WORDLE_STATUS_LOST:    return "lost";
+    }
+    return "unknown";
+}
+
+
+int write_state(Response *response, int status, unsigned long long id, const Wordle_Game *game)
+{
+    response->status = status;
+    response->body_len = 0;
+    append_cstr(response, "{\"id\":");
+    append_u64(response, id);
+    append_cstr(response, ",\"status\":\"");
+    append_cstr(response, status_name(wordle_game_status(game)));
+    append_cstr(response, "\",\"attempt\":");
+    append_u64(response, game->attempt);
+    append_cstr(response, ",\"guesses\":[");
+    for (int i = 0; i < game->attempt; ++i) {
+        char guess[WORD_LEN];
+        Wordle_Feedback feedback_values[WORD_LEN];
+        char feedback[WORD_LEN];
+        wordle_game_guess(game, i, guess);
+        wordle_game_feedback(game, i, feedback_values);
+        for (int j = 0; j < WORD_LEN; ++j) feedback[j] = feedback_chars[feedback_values[j]];
+        if (i > 0) append_cstr(response, ",");
+        append_cstr(response, "{\"word\":\"");
+        append_buf(response, guess, WORD_LEN);
+        append_cstr(response, "\",\"feedback\":\"");
+        append_buf(response, feedback, WORD_LEN);
+        append_cstr(response, "\"}");
+    }
+    append_cstr(response, "]");
+    if (wordle_game_status(game) != WORDLE_STATUS_PLAYING) {
+        append_cstr(response, ",\"answer\":\"");
+        append_cstr(response, wordle_answer(game));
+        append_cstr(response, "\"");
+    }
+    append_cstr(response, "}");
+    return status;
+}
+
+
+int write_error(Response *response, int status, const char *message)
+{
+    response->status = status;
+    response->body_len = 0;
+    append_cstr(response, "{\"error\":\"");
+    append_cstr(response, message);
+    append_cstr(response, "\"}");
+    return status;
+}
+
+
+/* Finds the string value of "guess" in the body. Good enough for the flat
+ * objects this API accepts, it is not a general JSON parser. */
+bool parse_guess(const char *body, size_t body_len, char *guess)
+{
+    static const char key[] = "\"guess\"";
+    const char *end = body + body_len;
+    const char *p = body;
+    for (; p + sizeof(key) - 1 <= end; ++p) {
+        if (memcmp(p, key, sizeof(key) - 1) == 0) break;
+    }
+    if (p + sizeof(key) - 1 > end) return false;
+    p += sizeof(key) - 1;
+
+    while (p < end && (*p == ' ' || *p == ':' || *p == '\t' || *p == '\n' || *p == '\r')) ++p;
+    if (p >= end || *p != '"') return false;
+    ++p;
+
+    for (int i = 0; i < WORD_LEN; ++i, ++p) {
+        if (p >= end) return false;
+        char c = *p;
+        if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+        if (c < 'A' || c > 'Z') return false;
+        guess[i] = c;
+    }
+    return p < end && *p == '"';
+}
+
+
+/* Routing */
+
+bool method_is(const Request *request, const char *method)
+{
+    return request->method_len == strlen(method) && memcmp(request->method, method, request->method_len) == 0;
+}
+
+
+/* Parses /games/{id}[/guesses], returns false for any other path */
+bool parse_game_path(const Request *request, unsigned long long *id, bool *guesses)
+{
+    static const char prefix[] = "/games/";
+    const char *p = request->path;
+    const char *end = request->path + request->path_len;
+    if ((size_t)(end - p) < sizeof(prefix) || memcmp(p, prefix, sizeof(prefix) - 1) != 0) return false;
+    p += sizeof(prefix) - 1;
+
+    *id = 0;
+    const char *digits = p;
+    while (p < end && *p >= '0' && *p <= '9' && p - digits < 20) {
+        *id = *id*10 + (*p - '0');
+        ++p;
+    }
+    if (p == digits) return false;
+
+    if (p == end) {
+        *guesses = false;
+        return true;
+    }
+    static const char suffix[] = "/guesses";
+    *guesses = true;
+    return (size_t)(end - p) == sizeof(suffix) - 1 && memcmp(p, suffix, sizeof(suffix) - 1) == 0;
+}
+
+
+/* Fills the response and returns its status */
+int handle_request(Shard *shard, const Request *request, Response *response)
+{
+    if (request->path_len == strlen("/games") && memcmp(request->path, "/games", request->path_len) == 0) {
+        if (!method_is(request, "POST")) return write_error(response, 405, "method not allowed");
+
+        unsigned long long id;
+        Session *session = alloc_session(shard, &id);
+        if (session == NULL) return write_error(response, 503, "too many games");
+        wordle_new_game(&session->game, random_answer(shard));
+        return write_state(response, 201, id, &session->game);
+    }
+
+    unsigned long long id;
+    bool guesses;
+    if (!parse_game_path(request, &id, &guesses)) return write_error(response, 404, "not found");
+
+    Session *session = find_session(shard, id);
+    if (session == NULL) return write_error(response, 404, "no such game");
+
+    if (guesses) {
+        if (!method_is(request, "POST")) return write_error(response, 405, "method not allowed");
+
+        char guess[WORD_LEN];
+        if (!parse_guess(request->body, request->body_len, guess)) return write_error(response, 400, "expected {\"guess\": \"WORD\"}");
+
+        switch (wordle_submit_guess(&session->game, guess)) {
+            case WORDLE_GUESS_ACCEPTED:     return write_state(response, 200, id, &session->game);
+            case WORDLE_GUESS_INCOMPLETE:   return write_error(response, 400, "incomplete guess");
+            case WORDLE_GUESS_UNKNOWN_WORD: return write_error(response, 422, "unknown word");
+            case WORDLE_GUESS_GAME_OVER:    return write_error(response, 409, "game is over");
+        }
+        return write_error(response, 500, "unexpected guess result");
+    }
+
+    if (method_is(request, "GET")) return write_state(response, 200, id, &session->game);
+    if (method_is(request, "DELETE")) {
+        free_session(shard, session);
+        response->status = 204;
+        response->body_len = 0;
+        return response->status;
+    }
+    return write_error(response, 405, "method not allowed");
+}
+
+
+/* HTTP */
+
+const char *status_text(int status)
+{
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 422: return "Unprocessable Entity";
+        case 503: return "Service Unavailable";
+        default:  return "Internal Server Error";
+    }
+}
+
+
+bool header_is(const char *line, size_t len, const char *name)
+{
+    size_t name_len = strlen(name);
+    return len > name_len && line[name_len] == ':' && strncasecmp(line, name, name_len) == 0;
+}
+
+
+const char *header_value(const char *line, size_t len, const char *name, size_t *value_len)
+{
+    const char *value = line + strlen(name) + 1;
+    const char *end = line + len;
+    while (value < end && (*value == ' ' || *value == '\t')) ++value;
+    *value_len = end - value;
+    return value;
+}
+
+
+/* Returns the size of the first complete request in the buffer, 0 if more
+ * bytes are needed and -1 if the request is malformed */
+long parse_request(const char *buffer, size_t len, Request *request)
+{
+    const char *end = buffer + len;
+    const char *headers_end = NULL;
+    for (const char *p = buffer; p + 3 < end; ++p) {
+        if (p[0] == '\r' && p[1] == '\n' && p[2] == '\r' && p[3] == '\n') {
+            headers_end = p + 4;
+            break;
+        }
+    }
+    if (headers_end == NULL) return len >= CONN_BUFFER_SIZE ? -1 : 0;
+
+    const char *line_end = memchr(buffer, '\r', headers_end - buffer);
+    const char *method_end = memchr(buffer, ' ', line_end - buffer);
+    if (method_end == NULL) return -1;
+    const char *path = method_end + 1;
+    const char *path_end = memchr(path, ' ', line_end - path);
+    if (path_end == NULL) return -1;
+    const char *version = path_end + 1;
+
+    request->method = buffer;
+    request->method_len = method_end - buffer;
+    request->path = path;
+    request->path_len = path_end - path;
+    request->keep_alive = (size_t)(line_end - version) == strlen("HTTP/1.1") && memcmp(version, "HTTP/1.1", 8) == 0;
+
+    size_t content_length = 0;
+    for (const char *line = line_end + 2; line < headers_end - 2;) {
+        const char *next = memchr(line, '\r', headers_end - line);
+        size_t line_len = next - line;
+        size_t value_len;
+        if (header_is(line, line_len, "Content-Length")) {
+            const char *value = header_value(line, line_len, "Content-Length", &value_len);
+            content_length = strtoul(value, NULL, 10);
+        } else if (header_is(line, line_len, "Connection")) {
+            const char *value = header_value(line, line_len, "Connection", &value_len);
+            if (value_len == 5 && strncasecmp(value, "close", 5) == 0) request->keep_alive = false;
+            if (value_len == 10 && strncasecmp(value, "keep-alive", 10) == 0) request->keep_alive = true;
+        }
+        line = next + 2;
+    }
+
+    if (content_length > CONN_BUFFER_SIZE) return -1;
+    if ((size_t)(end - headers_end) < content_length) {
+        return (size_t)(headers_end - buffer) + content_length > CONN_BUFFER_SIZE ? -1 : 0;
+    }
+
+    request->body = headers_end;
+    request->body_len = content_length;
+    return (headers_end - buffer) + content_length;
+}
+
+
+void append_response(Conn *conn, const Response *response, bool keep_alive)
+{
+    char head[256];
+    int head_len = snprintf(head, sizeof(head),
+        "HTTP/1.1 %d %s\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: %zu\r\n"
+        "%s"
+        "\r\n",
+        response->status, status_text(response->status), response->body_len,
+        keep_alive ? "" : "Connection: close\r\n");
+
+    if (conn->out_len + head_len + response->body_len > CONN_BUFFER_SIZE) {
+        conn->close_after_write = true;
+        return;
+    }
+    memcpy(conn->out + conn->out_len, head, head_len);
+    conn->out_len += head_len;
+    memcpy(conn->out + conn->out_len, response->body, response->body_len);
+    conn->out_len += response->body_len;
+}
+
+
+/* Shard owning the game the request refers to, or the given shard for
+ * requests that do not name a game or name one no shard could own */
+int request_shard(const Shard *shard, const Request *request)
+{
+    unsigned long long id;
+    bool guesses;
+    if (!parse_game_path(request, &id, &guesses)) return shard->index;
+    int owner = session_shard(id);
+    return owner < shard_count ? owner : shard->index;
+}
+
+
+/* Answers every complete request in the input buffer. Stops early when the
+ * output buffer could overflow, the rest is handled after it drains. Stops
+ * as well at a request for a game of another shard and leaves it in the
+ * buffer for the owner. */
+void process_input(Shard *shard, Conn *conn)
+{
+    size_t offset = 0;
+    conn->handoff_to = -1;
+    while (!conn->close_after_write && conn->out_len + MAX_RESPONSE_SIZE + 256 <= CONN_BUFFER_SIZE) {
+        Request request = {0};
+        long size = parse_request(conn->in + offset, conn->in_len - offset, &request);
+        if (size == 0) break;
+
+        Response *response = &shard->response;
+        if (size < 0) {
+            write_error(response, conn->in_len - offset >= CONN_BUFFER_SIZE ? 413 : 400, "bad request");
+            append_response(conn, response, false);
+            conn->close_after_write = true;
+            break;
+        }
+
+        int owner = request_shard(shard, &request);
+        if (owner != shard->index) {
+            conn->handoff_to = owner;
+            break;
+        }
+
+        handle_request(shard, &request, response);
+        append_response(conn, response, request.keep_alive);
+        if (!request.keep_alive) conn->close_after_write = true;
+        offset += size;
+    }
+
+    conn->in_len -= offset;
+    memmove(conn->in, conn->in + offset, conn->in_len);
+}
+
+
+/* Event loop */
+
+int listen_on(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) return -1;
+
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(yes));
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+void watch_conn(Shard *shard, Conn *conn, int op)
+{
+    struct epoll_event event = {0};
+    event.events = conn->out_len > conn->out_sent ? EPOLLOUT : EPOLLIN;
+    event.data.ptr = conn;
+    if (epoll_ctl(shard->epoll_fd, op, conn->fd, &event) < 0) free_conn(shard, conn);
+}
+
+
+/* Returns false once the connection should be closed */
+bool flush_output(Conn *conn)
+{
+    while (conn->out_sent < conn->out_len) {
+        ssize_t n = send(conn->fd, conn->out + conn->out_sent, conn->out_len - conn->out_sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        conn->out_sent += n;
+    }
+    conn->out_len = 0;
+    conn->out_sent = 0;
+    return !conn->close_after_write;
+}
+
+
+/* Alternates between answering buffered requests, sending the answers and
+ * reading more until the socket would block */
+Conn_Action serve_connection(Shard *shard, Conn *conn)
+{
+    for (;;) {
+        if (!flush_output(conn)) return CONN_CLOSE;
+        if (conn->out_len > 0) return CONN_KEEP;
+
+        process_input(shard, conn);
+        if (conn->out_len > 0) continue;
+        if (conn->handoff_to >= 0) return CONN_HANDOFF;
+
+        ssize_t n = recv(conn->fd, conn->in + conn->in_len, CONN_BUFFER_SIZE - conn->in_len, 0);
+        if (n == 0) return CONN_CLOSE;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK ? CONN_KEEP : CONN_CLOSE;
+        }
+        conn->in_len += n;
+    }
+}
+
+
+/* Gives the connection and its unanswered input to the shard owning the
+ * game it asks about. Only done once every earlier response is sent, so
+ * the responses stay in order. */
+void hand_off(Shard *shard, Conn *conn)
+{
+    Handoff *handoff = malloc(sizeof(*handoff));
+    if (handoff == NULL) {
+        free_conn(shard, conn);
+        return;
+    }
+    handoff->fd = conn->fd;
+    handoff->in_len = conn->in_len;
+    memcpy(handoff->in, conn->in, conn->in_len);
+
+    /* The pipe only fills up if the owner has stopped reading it, there is
+     * nothing better to do with the client than to drop it then */
+    if (write(shards[conn->handoff_to].handoff_pipe[1], &handoff, sizeof(handoff)) != sizeof(handoff)) {
+        free(handoff);
+        free_conn(shard, conn);
+        return;
+    }
+    release_conn(shard, conn);
+}
+
+
+void after_serve(Shard *shard, Conn *conn, Conn_Action action, int op)
+{
+    switch (action) {
+        case CONN_KEEP:    watch_conn(shard, conn, op); break;
+        case CONN_CLOSE:   free_conn(shard, conn);      break;
+        case CONN_HANDOFF: {
+            epoll_ctl(shard->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+            hand_off(shard, conn);
+        } break;
+    }
+}
+
+
+void epoll_receive_handoffs(Shard *shard)
+{
+    Handoff *handoff;
+    while (read(shard->handoff_pipe[0], &handoff, sizeof(handoff)) == sizeof(handoff)) {
+        Conn *conn = alloc_conn(shard, handoff->fd);
+        if (conn == NULL) {
+            close(handoff->fd);
+            free(handoff);
+            continue;
+        }
+        conn->in_len = handoff->in_len;
+        memcpy(conn->in, handoff->in, handoff->in_len);
+        free(handoff);
+
+        after_serve(shard, conn, serve_connection(shard, conn), EPOLL_CTL_ADD);
+    }
+}
+
+
+void epoll_accept_connections(Shard *shard)
+{
+    for (;;) {
+        int fd = accept4(shard->listen_fd, NULL, NULL, SOCK_NONBLOCK);
+        if (fd < 0) return;
+
+        Conn *conn = alloc_conn(shard, fd);
+        if (conn == NULL) {
+            close(fd);
+            continue;
+        }
+
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        watch_conn(shard, conn, EPOLL_CTL_ADD);
+    }
+}
+
+
+void run_epoll_shard(Shard *shard)
+{
+    shard->epoll_fd = epoll_create1(0);
+    if (shard->epoll_fd < 0) {
+        fprintf(stderr, "ERROR: could not create epoll: %s\n", strerror(errno));
+        exit(1);
+    }
+
+    struct epoll_event event = {0};
+    event.events = EPOLLIN;
+    event.data.ptr = &listener_tag;
+    epoll_ctl(shard->epoll_fd, EPOLL_CTL_ADD, shard->listen_fd, &event);
+    event.data.ptr = &handoff_tag;
+    epoll_ctl(shard->epoll_fd, EPOLL_CTL_ADD, shard->handoff_pipe[0], &event);
+
+    struct epoll_event events[MAX_EVENTS];
+    for (;;) {
+        int count = epoll_wait(shard->epoll_fd, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "ERROR: epoll_wait failed: %s\n", strerror(errno));
+            exit(1);
+        }
+
+        for (int i = 0; i < count; ++i) {
+            void *ptr = events[i].data.ptr;
+            if (ptr == &listener_tag) {
+                epoll_accept_connections(shard);
+            } else if (ptr == &handoff_tag) {
+                epoll_receive_handoffs(shard);
+            } else {
+                Conn *conn = ptr;
+                after_serve(shard, conn, serve_connection(shard, conn), EPOLL_CTL_MOD);
+            }
+        }
+    }
+}
+
+
+#ifdef HAVE_IO_URING
+/* io_uring backend. Operations on a connection carry the Conn pointer with
+ * the kind of operation in the low bits as their user_data. */
+
+#define URING_OP_RECV       1
+#define URING_OP_SEND       2
+#define URING_OP_CANCEL     3
+#define URING_OP_MASK       7
+#define URING_ACCEPT        ((unsigned long long)(uintptr_t) &listener_tag)
+#define URING_HANDOFF       ((unsigned long long)(uintptr_t) &handoff_tag)
+
+_Static_assert(_Alignof(Conn) > URING_OP_MASK, "Conn pointers must leave room for the operation");
+
+
+int uring_setup(unsigned entries, struct io_uring_params *params)
+{
+    return syscall(__NR_io_uring_setup, entries, params);
+}
+
+
+int uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+
+int uring_register(int fd, unsigned opcode, void *arg, unsigned count)
+{
+    return syscall(__NR_io_uring_register, fd, opcode, arg, count);
+}
+
+
+bool uring_init(Ring *ring)
+{
+    struct io_uring_params params = {0};
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER;
+    params.cq_entries = URING_ENTRIES*4;
+    ring->fd = uring_setup(URING_ENTRIES, &params);
+    if (ring->fd < 0) return false;
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        errno = ENOSYS;
+        return false;
+    }
+
+    size_t sq_size = params.sq_off.array + params.sq_entries*sizeof(unsigned);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries*sizeof(struct io_uring_cqe);
+    size_t rings_size = sq_size > cq_size ? sq_size : cq_size;
+    char *rings = mmap(NULL, rings_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (rings == MAP_FAILED) return false;
+    ring->rings = rings;
+    ring->rings_size = rings_size;
+    ring->sqes_size = params.sq_entries*sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) return false;
+
+    ring->sq_head = (unsigned *)(rings + params.sq_off.head);
+    ring->sq_tail = (unsigned *)(rings + params.sq_off.tail);
+    ring->sq_mask = *(unsigned *)(rings + params.sq_off.ring_mask);
+    ring->sq_entries = params.sq_entries;
+    ring->sq_array = (unsigned *)(rings + params.sq_off.array);
+    ring->cq_head = (unsigned *)(rings + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(rings + params.cq_off.tail);
+    ring->cq_mask = *(unsigned *)(rings + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(rings + params.cq_off.cqes);
+    ring->to_submit = 0;
+
+    /* Receive buffers are handed to the kernel through a ring of their own,
+     * every completed recv names the buffer it filled */
+    size_t buf_ring_size = URING_BUFFERS*sizeof(struct io_uring_buf);
+    ring->buf_ring = mmap(NULL, buf_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring->buf_ring == MAP_FAILED) return false;
+    ring->buffers = alloc_or_die(URING_BUFFERS, URING_BUFFER_SIZE);
+
+    struct io_uring_buf_reg reg = {0};
+    reg.ring_addr = (unsigned long long)(uintptr_t) ring->buf_ring;
+    reg.ring_entries = URING_BUFFERS;
+    reg.bgid = URING_BUFFER_GROUP;
+    if (uring_register(ring->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) return false;
+
+    for (int i = 0; i < URING_BUFFERS; ++i) {
+        struct io_uring_buf *buf = &ring->buf_ring->bufs[i];
+        buf->addr = (unsigned long long)(uintptr_t)(ring->buffers + (size_t) i*URING_BUFFER_SIZE);
+        buf->len = URING_BUFFER_SIZE;
+        buf->bid = i;
+    }
+    __atomic_store_n(&ring->buf_ring->tail, URING_BUFFERS, __ATOMIC_RELEASE);
+    return true;
+}
+
+
+/* Gives a receive buffer back to the kernel */
+void uring_recycle_buffer(Ring *ring, unsigned short bid)
+{
+    unsigned short tail = ring->buf_ring->tail;
+    struct io_uring_buf *buf = &ring->buf_ring->bufs[tail & (URING_BUFFERS - 1)];
+    buf->addr = (unsigned long long)(uintptr_t)(ring->buffers + (size_t) bid*URING_BUFFER_SIZE);
+    buf->len = URING_BUFFER_SIZE;
+    buf->bid = bid;
+    __atomic_store_n(&ring->buf_ring->tail, (unsigned short)(tail + 1), __ATOMIC_RELEASE);
+}
+
+
+/* Submits the queued operations and waits for at least min_complete
+ * completions */
+void uring_submit(Ring *ring, unsigned min_complete)
+{
+    for (;;) {
+        int n = uring_enter(ring->fd, ring->to_submit, min_complete, min_complete > 0 ? IORING_ENTER_GETEVENTS : 0);
+        if (n >= 0) {
+            ring->to_submit -= n;
+            return;
+        }
+        if (errno == EINTR) continue;
+        /* Completions have to be reaped before more can be submitted */
+        if (errno == EAGAIN || errno == EBUSY) return;
+        fprintf(stderr, "ERROR: io_uring_enter failed: %s\n", strerror(errno));
+        exit(1);
+    }
+}
+
+
+struct io_uring_sqe *uring_get_sqe(Ring *ring)
+{
+    unsigned tail = *ring->sq_tail;
+    while (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) >= ring->sq_entries) {
+        uring_submit(ring, 0);
+    }
+    struct io_uring_sqe *sqe = &ring->sqes[tail & ring->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_array[tail & ring->sq_mask] = tail & ring->sq_mask;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->to_submit += 1;
+    return sqe;
+}
+
+
+unsigned long long conn_user_data(Conn *conn, int op)
+{
+    return (unsigned long long)(uintptr_t) conn | op;
+}
+
+
+void uring_accept(Shard *shard)
+{
+    struct io_uring_sqe *sqe = uring_get_sqe(&shard->ring);
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = shard->listen_fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = URING_ACCEPT;
+}
+
+
+void uring_poll_handoffs(Shard *shard)
+{
+    struct io_uring_sqe *sqe = uring_get_sqe(&shard->ring);
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = shard->handoff_pipe[0];
+    sqe->poll32_events = POLLIN;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = URING_HANDOFF;
+}
+
+
+void uring_recv(Shard *shard, Conn *conn)
+{
+    struct io_uring_sqe *sqe = uring_get_sqe(&shard->ring);
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = conn->fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUFFER_GROUP;
+    sqe->user_data = conn_user_data(conn, URING_OP_RECV);
+    conn->recv_armed = true;
+}
+
+
+void uring_send(Shard *shard, Conn *conn)
+{
+    struct io_uring_sqe *sqe = uring_get_sqe(&shard->ring);
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = conn->fd;
+    sqe->addr = (unsigned long long)(uintptr_t)(conn->out + conn->out_sent);
+    sqe->len = conn->out_len - conn->out_sent;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = conn_user_data(conn, URING_OP_SEND);
+    conn->send_in_flight = true;
+}
+
+
+void uring_cancel_recv(Shard *shard, Conn *conn)
+{
+    if (!conn->recv_armed) return;
+    struct io_uring_sqe *sqe = uring_get_sqe(&shard->ring);
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = conn_user_data(conn, URING_OP_RECV);
+    sqe->user_data = conn_user_data(conn, URING_OP_CANCEL);
+}
+
+
+/* Closes or hands off the connection once the kernel is done with it. Safe
+ * to call again on the released connection. */
+void uring_settle(Shard *shard, Conn *conn)
+{
+    if (conn->recv_armed || conn->send_in_flight) return;
+    if (conn->closing) {
+        conn->closing = false;
+        free_conn(shard, conn);
+    } else if (conn->handing_off) {
+        conn->handing_off = false;
+        hand_off(shard, conn);
+    }
+}
+
+
+void uring_close(Shard *shard, Conn *conn)
+{
+    conn->closing = true;
+    shutdown(conn->fd, SHUT_RDWR);
+    uring_cancel_recv(shard, conn);
+    uring_settle(shard, conn);
+}
+
+
+/* Same steps as serve_connection, driven by completions instead of
+ * readiness. Input keeps arriving from the multishot recv. */
+void uring_serve(Shard *shard, Conn *conn)
+{
+    if (conn->closing || conn->handing_off || conn->send_in_flight) return;
+
+    process_input(shard, conn);
+    if (conn->out_len > 0) {
+        uring_send(shard, conn);
+    } else if (conn->close_after_write) {
+        uring_close(shard, conn);
+    } else if (conn->handoff_to >= 0) {
+        /* Whatever the recv still delivers is appended to the input and
+         * travels with the connection */
+        conn->handing_off = true;
+        uring_cancel_recv(shard, conn);
+        uring_settle(shard, conn);
+    } else if (!conn->recv_armed) {
+        uring_recv(shard, conn);
+    }
+}
+
+
+void uring_on_recv(Shard *shard, Conn *conn, struct io_uring_cqe *cqe)
+{
+    if (!(cqe->flags & IORING_CQE_F_MORE)) conn->recv_armed = false;
+
+    if (cqe->res > 0) {
+        unsigned short bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+        size_t size = cqe->res;
+        bool fits = conn->in_len + size <= CONN_BUFFER_SIZE;
+        if (fits && !conn->closing) {
+            memcpy(conn->in + conn->in_len, shard->ring.buffers + (size_t) bid*URING_BUFFER_SIZE, size);
+            conn->in_len += size;
+        }
+        uring_recycle_buffer(&shard->ring, bid);
+        /* The recv does not wait for earlier requests to be answered, a
+         * client piling up more unanswered input than fits is dropped */
+        if (!fits && !conn->closing) {
+            /* uring_close settles, so the connection may be freed already */
+            uring_close(shard, conn);
+            return;
+        }
+        uring_serve(shard, conn);
+    } else if (cqe->res == -ENOBUFS) {
+        /* Out of receive buffers, the recv is armed again */
+        uring_serve(shard, conn);
+    } else if (cqe->res != -ECANCELED) {
+        if (!conn->closing && !conn->handing_off) uring_close(shard, conn);
+    }
+    uring_settle(shard, conn);
+}
+
+
+void uring_on_send(Shard *shard, Conn *conn, struct io_uring_cqe *cqe)
+{
+    conn->send_in_flight = false;
+    if (cqe->res <= 0 || conn->closing) {
+        if (!conn->closing) uring_close(shard, conn);
+        uring_settle(shard, conn);
+        return;
+    }
+
+    conn->out_sent += cqe->res;
+    if (conn->out_sent < conn->out_len) {
+        uring_send(shard, conn);
+        return;
+    }
+    conn->out_len = 0;
+    conn->out_sent = 0;
+    if (conn->close_after_write) {
+        uring_close(shard, conn);
+        return;
+    }
+    uring_serve(shard, conn);
+}
+
+
+void uring_receive_handoffs(Shard *shard)
+{
+    Handoff *handoff;
+    while (read(shard->handoff_pipe[0], &handoff, sizeof(handoff)) == sizeof(handoff)) {
+        Conn *conn = alloc_conn(shard, handoff->fd);
+        if (conn == NULL) {
+            close(handoff->fd);
+            free(handoff);
+            continue;
+        }
+        conn->in_len = handoff->in_len;
+        memcpy(conn->in, handoff->in, handoff->in_len);
+        free(handoff);
+        uring_serve(shard, conn);
+    }
+}
+
+
+void uring_on_accept(Shard *shard, struct io_uring_cqe *cqe)
+{
+    if (!(cqe->flags & IORING_CQE_F_MORE)) uring_accept(shard);
+    if (cqe->res < 0) return;
+
+    Conn *conn = alloc_conn(shard, cqe->res);
+    if (conn == NULL) {
+        close(cqe->res);
+        return;
+    }
+    int yes = 1;
+    setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    uring_recv(shard, conn);
+}
+
+
+void run_uring_shard(Shard *shard)
+{
+    Ring *ring = &shard->ring;
+    if (!uring_init(ring)) {
+        fprintf(stderr, "ERROR: could not set up io_uring for shard %d: %s\n", shard->index, strerror(errno));
+        exit(1);
+    }
+    uring_accept(shard);
+    uring_poll_handoffs(shard);
+
+    for (;;) {
+        uring_submit(ring, 1);
+
+        unsigned head = *ring->cq_head;
+        unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            struct io_uring_cqe cqe = ring->cqes[head & ring->cq_mask];
+            /* Handing the slot back right away lets the handlers below
+             * submit without the ring filling up */
+            __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+
+            if (cqe.user_data == URING_ACCEPT) {
+                uring_on_accept(shard, &cqe);
+                continue;
+            }
+            if (cqe.user_data == URING_HANDOFF) {
+                if (!(cqe.flags & IORING_CQE_F_MORE)) uring_poll_handoffs(shard);
+                uring_receive_handoffs(shard);
+                continue;
+            }
+
+            Conn *conn = (Conn *)(uintptr_t)(cqe.user_data & ~(unsigned long long) URING_OP_MASK);
+            switch (cqe.user_data & URING_OP_MASK) {
+                case URING_OP_RECV: uring_on_recv(shard, conn, &cqe); break;
+                case URING_OP_SEND: uring_on_send(shard, conn, &cqe); break;
+                default: break;
+            }
+        }
+    }
+}
+
+
+/* Checks that the kernel allows io_uring and supports everything the
+ * backend uses before any shard starts */
+bool uring_supported(void)
+{
+    Ring ring = {0};
+    ring.fd = -1;
+    ring.rings = MAP_FAILED;
+    ring.sqes = MAP_FAILED;
+    ring.buf_ring = MAP_FAILED;
+    bool ok = uring_init(&ring);
+    int saved = errno;
+    if (ring.rings != MAP_FAILED) munmap(ring.rings, ring.rings_size);
+    if (ring.sqes != MAP_FAILED) munmap(ring.sqes, ring.sqes_size);
+    if (ring.buf_ring != MAP_FAILED) munmap(ring.buf_ring, URING_BUFFERS*sizeof(struct io_uring_buf));
+    free(ring.buffers);
+    if (ring.fd >= 0) close(ring.fd);
+    errno = saved;
+    return ok;
+}
+#endif
+
+
+void *run_shard(void *arg)
+{
+    Shard *shard = arg;
+
+    /* Pools are allocated by the thread that uses them so their pages land
+     * on its NUMA node */
+    init_sessions(&shard->sessions, sessions_per_shard);
+    init_conns(&shard->conns);
+
+    switch (backend) {
+        case BACKEND_EPOLL: run_epoll_shard(shard); break;
+        case BACKEND_IO_URING: {
+#ifdef HAVE_IO_URING
+            run_uring_shard(shard);
+#endif
+        } break;
+    }
+    return NULL;
+}
+
+
+bool init_shard(Shard *shard, int index, int port, unsigned long long seed)
+{
+    shard->index = index;
+    shard->rng_state = (seed ^ (index*0x9E3779B97F4A7C15ull)) | 1;
+    shard->listen_fd = listen_on(port);
+    if (shard->listen_fd < 0) {
+        fprintf(stderr, "ERROR: could not listen on 127.0.0.1:%d: %s\n", port, strerror(errno));
+        return false;
+    }
+    if (pipe2(shard->handoff_pipe, O_NONBLOCK) < 0) {
+        fprintf(stderr, "ERROR: could not set up shard %d: %s\n", index, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+
+int main(int argc, char **argv)
+{
+    int port = DEFAULT_PORT;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = cpus > 0 ? cpus : 1;
+    unsigned long long seed = 0x9E3779B97F4A7C15ull;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sessions") == 0 && i + 1 < argc) {
+            sessions_per_shard = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--idle-timeout") == 0 && i + 1 < argc) {
+            idle_timeout = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--backend") == 0 && i + 1 < argc && strcmp(argv[i + 1], "epoll") == 0) {
+            backend = BACKEND_EPOLL;
+            i += 1;
+        } else if (strcmp(argv[i], "--backend") == 0 && i + 1 < argc && strcmp(argv[i + 1], "io_uring") == 0) {
+            backend = BACKEND_IO_URING;
+            i += 1;
+        } else {
+            fprintf(stderr, "Usage: %s [--port N] [--threads N] [--sessions N] [--seed N]\n", argv[0]);
+            fprintf(stderr, "       %*s [--idle-timeout SECONDS] [--backend epoll|io_uring]\n", (int) strlen(argv[0]), "");
+            return 1;
+        }
+    }
+    if (backend == BACKEND_IO_URING) {
+#ifdef HAVE_IO_URING
+        if (!uring_supported()) {
+            fprintf(stderr, "ERROR: io_uring backend is not supported by the kernel: %s\n", strerror(errno));
+            return 1;
+        }
+#else
+        fprintf(stderr, "ERROR: io_uring backend was not compiled in, the kernel headers are too old\n");
+        return 1;
+#endif
+    }
+    if (sessions_per_shard <= 0 || sessions_per_shard > MAX_SESSIONS) {
+        fprintf(stderr, "ERROR: --sessions must be between 1 and %d\n", MAX_SESSIONS);
+        return 1;
+    }
+    if (idle_timeout <= 0) {
+        fprintf(stderr, "ERROR: --idle-timeout must be positive\n");
+        return 1;
+    }
+    if (threads <= 0 || threads > MAX_SHARDS) {
+        fprintf(stderr, "ERROR: --threads must be between 1 and %d\n", MAX_SHARDS);
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    shard_count = threads;
+    shards = alloc_or_die(shard_count, sizeof(*shards));
+    for (int i = 0; i < shard_count; ++i) {
+        if (!init_shard(&shards[i], i, port, seed)) return 1;
+    }
+    printf("Serving %d games per shard on http://127.0.0.1:%d with %d %s shards\n",
+           sessions_per_shard, port, shard_count, backend == BACKEND_EPOLL ? "epoll" : "io_uring");
+    fflush(stdout);
+
+    for (int i = 0; i < shard_count; ++i) {
+        if (pthread_create(&shards[i].thread, NULL, run_shard, &shards[i]) != 0) {
+            fprintf(stderr, "ERROR: could not start shard %d\n", i);
+            return 1;
+        }
+        if (cpus > 0) {
+            cpu_set_t cpu;
+            CPU_ZERO(&cpu);
+            CPU_SET(i % cpus, &cpu);
+            pthread_setaffinity_np(shards[i].thread, sizeof(cpu), &cpu);
+        }
+    }
+    for (int i = 0; i < shard_count; ++i) pthread_join(shards[i].thread, NULL);
+    return 0;
+}
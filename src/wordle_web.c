@@ -0,0 +1,714 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+// Static file server for the wasm build of the game.
+//
+//     wordle-web [--port N] [--root DIR] [--precompressed DIR]
+//
+// Serves index.html and everything under wasm/, js/ and assets/ of the root.
+// The files are opened and hashed once at startup and their bodies are sent
+// with sendfile. A file with a .br or .gz copy under the precompressed
+// directory, as `./nob serve` produces, is sent in the best encoding the
+// client accepts.
+//
+// Every response carries an ETag and If-None-Match is answered with 304.
+// index.html is served from memory with the ETag of each asset it refers to
+// appended as ?v=, and requests carrying ?v= are cached as immutable. Other
+// requests have to be revalidated, so a rebuilt game is never stale.
+
+#define DEFAULT_PORT        6969
+#define MAX_FILES           64
+#define MAX_CONNECTIONS     1024
+#define MAX_EVENTS          64
+#define REQUEST_BUFFER_SIZE (8*1024)
+#define HEADER_BUFFER_SIZE  1024
+#define INDEX_PATH          "index.html"
+
+typedef enum Encoding {
+    ENCODING_IDENTITY,
+    ENCODING_GZIP,
+    ENCODING_BR,
+    ENCODING_COUNT,
+} Encoding;
+
+typedef struct Variant {
+    int fd;                         // -1 if there is no file in this encoding
+    off_t size;
+} Variant;
+
+typedef struct File {
+    char path[256];                 // Relative to the root, without the leading slash
+    const char *content_type;
+    char etag[24];                  // Hash of the content, quoted
+    Variant variants[ENCODING_COUNT];
+    char *data;                     // Body kept in memory instead of a file, only for index.html
+    size_t data_size;
+} File;
+
+typedef struct Conn {
+    int fd;
+    char in[REQUEST_BUFFER_SIZE];
+    size_t in_len;
+    char head[HEADER_BUFFER_SIZE];
+    size_t head_len;
+    size_t head_sent;
+    const char *body;               // Body from memory, or NULL
+    int body_fd;                    // Body from a file, or -1
+    off_t body_offset;
+    off_t body_end;
+    bool close_after_write;
+    int next_free;
+} Conn;
+
+typedef struct Request {
+    const char *method;
+    size_t method_len;
+    const char *path;
+    size_t path_len;
+    const char *query;              // After '?', NULL if there is none
+    size_t query_len;
+    const char *accept_encoding;
+    size_t accept_encoding_len;
+    const char *if_none_match;
+    size_t if_none_match_len;
+    bool keep_alive;
+} Request;
+
+static File files[MAX_FILES];
+static int files_count = 0;
+static Conn conns[MAX_CONNECTIONS];
+static int conns_free = 0;
+
+static const char *encoding_suffixes[ENCODING_COUNT] = {
+    [ENCODING_IDENTITY] = "",
+    [ENCODING_GZIP]     = ".gz",
+    [ENCODING_BR]       = ".br",
+};
+
+static const char *encoding_names[ENCODING_COUNT] = {
+    [ENCODING_IDENTITY] = "identity",
+    [ENCODING_GZIP]     = "gzip",
+    [ENCODING_BR]       = "br",
+};
+
+static const struct {
+    const char *extension;
+    const char *content_type;
+} content_types[] = {
+    { ".html", "text/html; charset=utf-8" },
+    { ".js",   "text/javascript; charset=utf-8" },
+    { ".wasm", "application/wasm" },
+    { ".ttf",  "font/ttf" },
+    { ".woff", "font/woff" },
+    { ".png",  "image/png" },
+    { ".svg",  "image/svg+xml" },
+    { ".txt",  "text/plain; charset=utf-8" },
+};
+
+
+const char *find_content_type(const char *path)
+{
+    const char *dot = strrchr(path, '.');
+    if (dot == NULL) return NULL;
+    for (size_t i = 0; i < sizeof(content_types)/sizeof(content_types[0]); ++i) {
+        if (strcmp(dot, content_types[i].extension) == 0) return content_types[i].content_type;
+    }
+    return NULL;
+}
+
+
+/* FNV-1a over the whole file */
+unsigned long long hash_fd(int fd)
+{
+    unsigned long long hash = 0xcbf29ce484222325ull;
+    char buffer[64*1024];
+    off_t offset = 0;
+    for (;;) {
+        ssize_t n = pread(fd, buffer, sizeof(buffer), offset);
+        if (n <= 0) break;
+        for (ssize_t i = 0; i < n; ++i) {
+            hash ^= (unsigned char) buffer[i];
+            hash *= 0x100000001b3ull;
+        }
+        offset += n;
+    }
+    return hash;
+}
+
+
+/* Opens a precompressed copy of the file if it is not older than the file */
+Variant open_variant(const char *precompressed_dir, const char *path, Encoding encoding, const struct stat *source)
+{
+    Variant variant = { .fd = -1, .size = 0 };
+    char variant_path[512];
+    snprintf(variant_path, sizeof(variant_path), "%s/%s%s", precompressed_dir, path, encoding_suffixes[encoding]);
+
+    int fd = open(variant_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return variant;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_mtime < source->st_mtime) {
+        fprintf(stderr, "WARNING: ignoring stale %s\n", variant_path);
+        close(fd);
+        return variant;
+    }
+    variant.fd = fd;
+    variant.size = st.st_size;
+    return variant;
+}
+
+
+void add_file(const char *root, const char *precompressed_dir, const char *path)
+{
+    const char *content_type = find_content_type(path);
+    if (content_type == NULL) return;
+    if (files_count >= MAX_FILES) {
+        fprintf(stderr, "WARNING: more than %d files, skipping %s\n", MAX_FILES, path);
+        return;
+    }
+
+    char full_path[512];
+    snprintf(full_path, sizeof(full_path), "%s/%s", root, path);
+    int fd = open(full_path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        fprintf(stderr, "WARNING: could not open %s: %s\n", full_path, strerror(errno));
+        if (fd >= 0) close(fd);
+        return;
+    }
+
+    File *file = &files[files_count++];
+    memset(file, 0, sizeof(*file));
+    snprintf(file->path, sizeof(file->path), "%s", path);
+    file->content_type = content_type;
+    snprintf(file->etag, sizeof(file->etag), "\"%016llx\"", hash_fd(fd));
+    file->variants[ENCODING_IDENTITY].fd = fd;
+    file->variants[ENCODING_IDENTITY].size = st.st_size;
+    for (int e = ENCODING_IDENTITY + 1; e < ENCODING_COUNT; ++e) {
+        file->variants[e] = open_variant(precompressed_dir, path, e, &st);
+    }
+}
+
+
+void add_dir(const char *root, const char *precompressed_dir, const char *dir)
+{
+    char full_path[512];
+    snprintf(full_path, sizeof(full_path), "%s/%s", root, dir);
+    DIR *d = opendir(full_path);
+    if (d == NULL) return;
+
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        char path[256];
+        int len = snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        if (len < 0 || (size_t) len >= sizeof(path)) continue;
+
+        char entry_path[512];
+        snprintf(entry_path, sizeof(entry_path), "%s/%s", root, path);
+        struct stat st;
+        if (stat(entry_path, &st) < 0) continue;
+        if (S_ISDIR(st.st_mode)) {
+            add_dir(root, precompressed_dir, path);
+        } else if (S_ISREG(st.st_mode)) {
+            add_file(root, precompressed_dir, path);
+        }
+    }
+    closedir(d);
+}
+
+
+File *find_file(const char *path, size_t path_len)
+{
+    for (int i = 0; i < files_count; ++i) {
+        if (strlen(files[i].path) == path_len && memcmp(files[i].path, path, path_len) == 0) return &files[i];
+    }
+    return NULL;
+}
+
+
+/* Loads index.html into memory with ?v=ETAG appended to every reference to
+ * a served file, so those requests can be cached forever */
+void version_index(File *index)
+{
+    Variant *identity = &index->variants[ENCODING_IDENTITY];
+    char *source = malloc(identity->size + 1);
+    if (source == NULL || pread(identity->fd, source, identity->size, 0) != identity->size) {
+        fprintf(stderr, "WARNING: could not read %s, serving it unversioned\n", index->path);
+        free(source);
+        return;
+    }
+    source[identity->size] = '\0';
+
+    size_t capacity = identity->size + files_count*32 + 1;
+    char *out = malloc(capacity);
+    if (out == NULL) {
+        free(source);
+        return;
+    }
+    size_t out_len = 0;
+    for (const char *p = source; *p != '\0';) {
+        /* References look like "./wasm/wordle.wasm" */
+        File *match = NULL;
+        if (p[0] == '.' && p[1] == '/') {
+            for (int i = 0; i < files_count; ++i) {
+                size_t len = strlen(files[i].path);
+                if (&files[i] != index && strncmp(p + 2, files[i].path, len) == 0 && (p[2 + len] == '"' || p[2 + len] == ')')) {
+                    match = &files[i];
+                    break;
+                }
+            }
+        }
+        if (match == NULL || out_len + strlen(match->path) + 32 > capacity) {
+            out[out_len++] = *p++;
+            continue;
+        }
+        size_t len = 2 + strlen(match->path);
+        memcpy(out + out_len, p, len);
+        out_len += len;
+        out_len += snprintf(out + out_len, capacity - out_len, "?v=%.*s", 16, match->etag + 1);
+        p += len;
+    }
+    free(source);
+
+    index->data = out;
+    index->data_size = out_len;
+    unsigned long long hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < out_len; ++i) {
+        hash ^= (unsigned char) out[i];
+        hash *= 0x100000001b3ull;
+    }
+    snprintf(index->etag, sizeof(index->etag), "\"%016llx\"", hash);
+}
+
+
+/* HTTP */
+
+bool header_is(const char *line, size_t len, const char *name)
+{
+    size_t name_len = strlen(name);
+    return len > name_len && line[name_len] == ':' && strncasecmp(line, name, name_len) == 0;
+}
+
+
+const char *header_value(const char *line, size_t len, const char *name, size_t *value_len)
+{
+    const char *value = line + strlen(name) + 1;
+    const char *end = line + len;
+    while (value < end && (*value == ' ' || *value == '\t')) ++value;
+    *value_len = end - value;
+    return value;
+}
+
+
+/* Returns the size of the first complete request in the buffer, 0 if more
+ * bytes are needed and -1 if the request is malformed. Request bodies are
+ * not expected and not supported. */
+long parse_request(const char *buffer, size_t len, Request *request)
+{
+    const char *end = buffer + len;
+    const char *headers_end = NULL;
+    for (const char *p = buffer; p + 3 < end; ++p) {
+        if (p[0] == '\r' && p[1] == '\n' && p[2] == '\r' && p[3] == '\n') {
+            headers_end = p + 4;
+            break;
+        }
+    }
+    if (headers_end == NULL) return len >= REQUEST_BUFFER_SIZE ? -1 : 0;
+
+    const char *line_end = memchr(buffer, '\r', headers_end - buffer);
+    const char *method_end = memchr(buffer, ' ', line_end - buffer);
+    if (method_end == NULL) return -1;
+    const char *target = method_end + 1;
+    const char *target_end = memchr(target, ' ', line_end - target);
+    if (target_end == NULL) return -1;
+    const char *version = target_end + 1;
+
+    request->method = buffer;
+    request->method_len = method_end - buffer;
+    request->path = target;
+    request->path_len = target_end - target;
+    const char *question = memchr(target, '?', target_end - target);
+    if (question != NULL) {
+        request->path_len = question - target;
+        request->query = question + 1;
+        request->query_len = target_end - request->query;
+    }
+    request->keep_alive = (size_t)(line_end - version) == strlen("HTTP/1.1") && memcmp(version, "HTTP/1.1", 8) == 0;
+
+    for (const char *line = line_end + 2; line < headers_end - 2;) {
+        const char *next = memchr(line, '\r', headers_end - line);
+        size_t line_len = next - line;
+        size_t value_len;
+        if (header_is(line, line_len, "Accept-Encoding")) {
+            request->accept_encoding = header_value(line, line_len, "Accept-Encoding", &request->accept_encoding_len);
+        } else if (header_is(line, line_len, "If-None-Match")) {
+            request->if_none_match = header_value(line, line_len, "If-None-Match", &request->if_none_match_len);
+        } else if (header_is(line, line_len, "Connection")) {
+            const char *value = header_value(line, line_len, "Connection", &value_len);
+            if (value_len == 5 && strncasecmp(value, "close", 5) == 0) request->keep_alive = false;
+            if (value_len == 10 && strncasecmp(value, "keep-alive", 10) == 0) request->keep_alive = true;
+        } else if (header_is(line, line_len, "Content-Length") || header_is(line, line_len, "Transfer-Encoding")) {
+            return -1;
+        }
+        line = next + 2;
+    }
+    return headers_end - buffer;
+}
+
+
+bool contains(const char *haystack, size_t haystack_len, const char *needle)
+{
+    size_t needle_len = strlen(needle);
+    for (size_t i = 0; i + needle_len <= haystack_len; ++i) {
+        if (memcmp(haystack + i, needle, needle_len) == 0) return true;
+    }
+    return false;
+}
+
+
+/* Picks the smallest encoding the client accepts and the file has. q=0 is
+ * not honored, no browser sends it for these encodings. */
+Encoding negotiate_encoding(const Request *request, const File *file)
+{
+    if (file->data != NULL || request->accept_encoding == NULL) return ENCODING_IDENTITY;
+    if (file->variants[ENCODING_BR].fd >= 0 && contains(request->accept_encoding, request->accept_encoding_len, "br")) return ENCODING_BR;
+    if (file->variants[ENCODING_GZIP].fd >= 0 && contains(request->accept_encoding, request->accept_encoding_len, "gzip")) return ENCODING_GZIP;
+    return ENCODING_IDENTITY;
+}
+
+
+void respond_error(Conn *conn, int status, const char *reason)
+{
+    conn->head_len = snprintf(conn->head, HEADER_BUFFER_SIZE,
+        "HTTP/1.1 %d %s\r\n"
+        "Content-Type: text/plain; charset=utf-8\r\n"
+        "Content-Length: %zu\r\n"
+        "Connection: close\r\n"
+        "\r\n"
+        "%s\n",
+        status, reason, strlen(reason) + 1, reason);
+    conn->close_after_write = true;
+}
+
+
+void respond(Conn *conn, const Request *request)
+{
+    bool head = request->method_len == 4 && memcmp(request->method, "HEAD", 4) == 0;
+    bool get = request->method_len == 3 && memcmp(request->method, "GET", 3) == 0;
+    if (!get && !head) {
+        respond_error(conn, 405, "Method Not Allowed");
+        return;
+    }
+
+    const char *path = request->path;
+    size_t path_len = request->path_len;
+    if (path_len == 0 || path[0] != '/') {
+        respond_error(conn, 400, "Bad Request");
+        return;
+    }
+    path += 1;
+    path_len -= 1;
+    if (path_len == 0) {
+        path = INDEX_PATH;
+        path_len = strlen(INDEX_PATH);
+    }
+
+    File *file = find_file(path, path_len);
+    if (file == NULL) {
+        respond_error(conn, 404, "Not Found");
+        return;
+    }
+
+    Encoding encoding = negotiate_encoding(request, file);
+    char etag[32];
+    if (encoding == ENCODING_IDENTITY) {
+        snprintf(etag, sizeof(etag), "%s", file->etag);
+    } else {
+        /* Every encoding is a different representation with its own tag */
+        snprintf(etag, sizeof(etag), "%.17s-%s\"", file->etag, encoding_names[encoding]);
+    }
+
+    bool versioned = request->query != NULL && request->query_len > 2 && memcmp(request->query, "v=", 2) == 0;
+    const char *cache_control = versioned ? "public, max-age=31536000, immutable" : "no-cache";
+    bool not_modified = request->if_none_match != NULL && contains(request->if_none_match, request->if_none_match_len, etag);
+    off_t size = file->data != NULL ? (off_t) file->data_size : file->variants[encoding].size;
+
+    /* A 304 may only repeat the length a 200 would send, so it sends none */
+    char content_length[48] = "";
+    if (!not_modified) snprintf(content_length, sizeof(content_length), "Content-Length: %lld\r\n", (long long) size);
+
+    conn->head_len = snprintf(conn->head, HEADER_BUFFER_SIZE,
+        "HTTP/1.1 %s\r\n"
+        "Content-Type: %s\r\n"
+        "%s"
+        "ETag: %s\r\n"
+        "Cache-Control: %s\r\n"
+        "Vary: Accept-Encoding\r\n"
+        "%s%s%s"
+        "%s"
+        "\r\n",
+        not_modified ? "304 Not Modified" : "200 OK",
+        file->content_type,
+        content_length,
+        etag,
+        cache_control,
+        encoding != ENCODING_IDENTITY ? "Content-Encoding: " : "",
+        encoding != ENCODING_IDENTITY ? encoding_names[encoding] : "",
+        encoding != ENCODING_IDENTITY ? "\r\n" : "",
+        request->keep_alive ? "" : "Connection: close\r\n");
+    conn->close_after_write = !request->keep_alive;
+    if (head || not_modified) return;
+
+    conn->body_offset = 0;
+    conn->body_end = size;
+    if (file->data != NULL) {
+        conn->body = file->data;
+    } else {
+        conn->body_fd = file->variants[encoding].fd;
+    }
+}
+
+
+/* Event loop */
+
+void init_conns(void)
+{
+    for (int i = 0; i < MAX_CONNECTIONS; ++i) {
+        conns[i].next_free = i + 1 < MAX_CONNECTIONS ? i + 1 : -1;
+    }
+    conns_free = 0;
+}
+
+
+Conn *alloc_conn(int fd)
+{
+    if (conns_free < 0) return NULL;
+    Conn *conn = &conns[conns_free];
+    conns_free = conn->next_free;
+    conn->fd = fd;
+    conn->in_len = 0;
+    conn->head_len = 0;
+    conn->head_sent = 0;
+    conn->body = NULL;
+    conn->body_fd = -1;
+    conn->close_after_write = false;
+    return conn;
+}
+
+
+void free_conn(Conn *conn)
+{
+    close(conn->fd);
+    conn->fd = -1;
+    conn->next_free = conns_free;
+    conns_free = conn - conns;
+}
+
+
+bool response_pending(const Conn *conn)
+{
+    return conn->head_sent < conn->head_len || conn->body != NULL || conn->body_fd >= 0;
+}
+
+
+/* Sends as much of the current response as the socket takes. Returns false
+ * if the connection failed. */
+bool send_response(Conn *conn)
+{
+    while (conn->head_sent < conn->head_len) {
+        int more = conn->body != NULL || conn->body_fd >= 0 ? MSG_MORE : 0;
+        ssize_t n = send(conn->fd, conn->head + conn->head_sent, conn->head_len - conn->head_sent, MSG_NOSIGNAL | more);
+        if (n < 0) return errno == EAGAIN || errno == EINTR;
+        conn->head_sent += n;
+    }
+
+    while (conn->body_offset < conn->body_end) {
+        ssize_t n;
+        if (conn->body != NULL) {
+            n = send(conn->fd, conn->body + conn->body_offset, conn->body_end - conn->body_offset, MSG_NOSIGNAL);
+            if (n > 0) conn->body_offset += n;
+        } else {
+            /* sendfile advances the offset itself and leaves the shared
+             * file position alone */
+            n = sendfile(conn->fd, conn->body_fd, &conn->body_offset, conn->body_end - conn->body_offset);
+        }
+        if (n < 0) return errno == EAGAIN || errno == EINTR;
+        if (n == 0) return false;
+    }
+
+    conn->head_len = 0;
+    conn->head_sent = 0;
+    conn->body = NULL;
+    conn->body_fd = -1;
+    return true;
+}
+
+
+/* Returns false once the connection should be closed */
+bool serve_connection(Conn *conn)
+{
+    for (;;) {
+        if (response_pending(conn)) {
+            if (!send_response(conn)) return false;
+            if (response_pending(conn)) return true;
+            if (conn->close_after_write) return false;
+        }
+
+        Request request = {0};
+        long size = parse_request(conn->in, conn->in_len, &request);
+        if (size < 0) {
+            respond_error(conn, 400, "Bad Request");
+            conn->in_len = 0;
+            continue;
+        }
+        if (size > 0) {
+            respond(conn, &request);
+            conn->in_len -= size;
+            memmove(conn->in, conn->in + size, conn->in_len);
+            continue;
+        }
+
+        ssize_t n = recv(conn->fd, conn->in + conn->in_len, REQUEST_BUFFER_SIZE - conn->in_len, 0);
+        if (n == 0) return false;
+        if (n < 0) return errno == EAGAIN || errno == EINTR;
+        conn->in_len += n;
+    }
+}
+
+
+int listen_on(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) return -1;
+
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+void run_event_loop(int listen_fd)
+{
+    int epoll_fd = epoll_create1(0);
+    if (epoll_fd < 0) {
+        fprintf(stderr, "ERROR: could not create epoll: %s\n", strerror(errno));
+        exit(1);
+    }
+
+    struct epoll_event event = {0};
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event);
+
+    struct epoll_event events[MAX_EVENTS];
+    for (;;) {
+        int count = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "ERROR: epoll_wait failed: %s\n", strerror(errno));
+            exit(1);
+        }
+
+        for (int i = 0; i < count; ++i) {
+            Conn *conn = events[i].data.ptr;
+            if (conn == NULL) {
+                for (;;) {
+                    int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                    if (fd < 0) break;
+                    Conn *accepted = alloc_conn(fd);
+                    if (accepted == NULL) {
+                        close(fd);
+                        continue;
+                    }
+                    event.events = EPOLLIN;
+                    event.data.ptr = accepted;
+                    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) free_conn(accepted);
+                }
+                continue;
+            }
+
+            if (!serve_connection(conn)) {
+                free_conn(conn);
+                continue;
+            }
+            event.events = response_pending(conn) ? EPOLLOUT : EPOLLIN;
+            event.data.ptr = conn;
+            epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn->fd, &event);
+        }
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    int port = DEFAULT_PORT;
+    const char *root = ".";
+    const char *precompressed_dir = "./build/www";
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--root") == 0 && i + 1 < argc) {
+            root = argv[++i];
+        } else if (strcmp(argv[i], "--precompressed") == 0 && i + 1 < argc) {
+            precompressed_dir = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--port N] [--root DIR] [--precompressed DIR]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    add_file(root, precompressed_dir, INDEX_PATH);
+    add_dir(root, precompressed_dir, "wasm");
+    add_dir(root, precompressed_dir, "js");
+    add_dir(root, precompressed_dir, "assets");
+    File *index = find_file(INDEX_PATH, strlen(INDEX_PATH));
+    if (index == NULL) {
+        fprintf(stderr, "ERROR: no %s in %s\n", INDEX_PATH, root);
+        return 1;
+    }
+    version_index(index);
+    init_conns();
+
+    int listen_fd = listen_on(port);
+    if (listen_fd < 0) {
+        fprintf(stderr, "ERROR: could not listen on 127.0.0.1:%d: %s\n", port, strerror(errno));
+        return 1;
+    }
+    for (int i = 0; i < files_count; ++i) {
+        printf("    /%-36s %8lld", files[i].path, (long long) files[i].variants[ENCODING_IDENTITY].size);
+        for (int e = ENCODING_IDENTITY + 1; e < ENCODING_COUNT; ++e) {
+            if (files[i].variants[e].fd >= 0) printf("  %s %lld", encoding_names[e], (long long) files[i].variants[e].size);
+        }
+        printf("\n");
+    }
+    printf("Serving %d files from %s on http://127.0.0.1:%d\n", files_count, root, port);
+    fflush(stdout);
+
+    run_event_loop(listen_fd);
+    return 0;
+}